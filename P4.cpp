@@ -38,6 +38,7 @@ execution and easier debugging.
 #include <memory>
 #include <vector>
 #include "nova.h"
+#include "nova_engine.h"
 
 using namespace std;
 
@@ -47,11 +48,11 @@ const int NUMLUMENS = 5;
 vector<unique_ptr<Nova>> novas;
 Luminosity luminate;
 
-void displayNovaGlows();
+void displayNovaGlows(const NovaEngine& engine);
 void displayGlowValues(const Nova& nova);
 void initializeNovas(int NUMNOVAS, int NUMLUMENS);
-void glowNovas(int NUMNOVAS, int lumensToGlow);
-void glowNovas50Times(int NUMNOVAS, int lumensToGlow);
+void glowNovas(NovaEngine& engine, int lumensToGlow);
+void glowNovas50Times(NovaEngine& engine, int lumensToGlow);
 void modifyNova(Nova& nova_object);
 void testNovaCopyingCallByValueAndAssignment(vector<unique_ptr<Nova>>& novav);
 void TestNovaMoveAssignment();
@@ -62,16 +63,17 @@ void testSharedPointer(vector<unique_ptr<Nova>>& novav);
 
 int main() {
     initializeNovas(NUMNOVAS, NUMLUMENS);
+    NovaEngine engine(novas); // glows and queries the whole fleet on every core
 
     std::cout << "********* Initializing all Novas ********* " << std::endl;
-    glowNovas(NUMNOVAS, 5);
+    glowNovas(engine, 5);
     std::cout << std::endl;
-    displayNovaGlows();
+    displayNovaGlows(engine);
 
     std::cout << "******** Glowing Lumens in Nova 50 times *******" << std::endl;
-    glowNovas50Times(NUMNOVAS, 5);
+    glowNovas50Times(engine, 5);
     std::cout << std::endl;
-    displayNovaGlows();
+    displayNovaGlows(engine);
 
     std::cout << "********* Copy *********" << std::endl;
     testNovaCopyingCallByValueAndAssignment(novas);
@@ -98,11 +100,14 @@ int main() {
     return 0;
 }
 
-void displayNovaGlows() {
-    // Display the glow values for each Nova object
-    for (size_t i = 0; i < novas.size(); ++i) {
+void displayNovaGlows(const NovaEngine& engine) {
+    // Min and max glow of every Nova are computed in parallel, then displayed in order
+    vector<NovaGlowRange> ranges = engine.glowRanges();
+    for (size_t i = 0; i < ranges.size(); ++i) {
         std::cout << "Glow values for Nova " << i + 1 << ":" << std::endl;
-        displayGlowValues(*novas[i]);
+        std::cout << "Min glow value: " << ranges[i].minGlow << std::endl;
+        std::cout << "Max glow value: " << ranges[i].maxGlow << std::endl;
+        std::cout << std::endl;
     }
 }
 
@@ -122,18 +127,12 @@ void initializeNovas(int NUMNOVAS, int NUMLUMENS) {
     }
 }
 
-void glowNovas(int NUMNOVAS, int lumensToGlow) {
-    for (auto& nova : novas) {
-        nova->glow(lumensToGlow);
-    }
+void glowNovas(NovaEngine& engine, int lumensToGlow) {
+    engine.glow(lumensToGlow);
 }
 
-void glowNovas50Times(int NUMNOVAS, int lumensToGlow) {
-    for (auto& nova : novas) {
-        for (int j = 0; j < 50; ++j) {
-            nova->glow(lumensToGlow);
-        }
-    }
+void glowNovas50Times(NovaEngine& engine, int lumensToGlow) {
+    engine.glow(lumensToGlow, 50);
 }
 
 void modifyNova(Nova& nova_object) {
@@ -0,0 +1,268 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+FixedNova.h is the header file for the FixedNova class template, a Nova whose number of lumens
+N is known at compile time (like NUMLUMENS = 5 in P4.cpp). Its lumens are LumenCells stored
+inline in a std::array, with no heap allocation, no factory and no bank. glow, min/max and
+recharge are written as fold expressions over the N indices, so every loop is fully unrolled
+and every LumenCell transition is inlined.
+
+A FixedNova follows exactly the rules of Nova: glow(x) glows the first x lumens and then
+recharges the active lumens if more than half of them are inactive. Through INova it can be
+driven by the same code as a dynamic Nova, and toNova() / FixedNova(const Nova&) convert
+between the two.
+*/
+
+#ifndef FIXED_NOVA_H
+#define FIXED_NOVA_H
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include "lumen_cell.h"
+#include "nova.h"
+#include "nova_metrics.h"
+
+constexpr int MAXFIXEDLUMENS = 64; // every loop is unrolled N times; larger Novas belong in Nova
+
+template <int N>
+class FixedNova final : public INova {
+    static_assert(N > 0 && N <= MAXFIXEDLUMENS, "FixedNova holds 1 to MAXFIXEDLUMENS lumens");
+
+public:
+    FixedNova(int initialBrightness, int initialSize, int initialPower);
+    explicit FixedNova(const Nova& nova); // copies a Nova of exactly N lumens
+
+    void glow(int x) override;
+    int minGlow() const override;
+    int maxGlow() const override;
+    int getNumLumens() const override;
+    int getNumActiveLumens() const override;
+    int getNumErraticLumens() const override;
+    int getNumInactiveLumens() const override;
+    int currentGlowValue(int index) const override;
+
+    LumenCell& lumen(int index); // per-element access, like Nova::lumen
+    const LumenCell& lumen(int index) const;
+    Nova toNova(ILuminosity* luminate) const; // a dynamic Nova with the same lumens, growing through luminate
+
+private:
+    using Indices = std::make_index_sequence<N>;
+
+    std::array<LumenCell, N> lumens;
+
+    template <std::size_t... I>
+    static std::array<LumenCell, N> makeLumens(int initialBrightness, int initialSize, int initialPower,
+                                               std::index_sequence<I...>);
+    template <std::size_t... I>
+    static std::array<LumenCell, N> copyLumens(const LumenBank& bank, std::index_sequence<I...>);
+    template <std::size_t... I>
+    void glowFirst(int x, std::index_sequence<I...>);
+    template <std::size_t... I>
+    int countInactive(std::index_sequence<I...>) const;
+    template <std::size_t... I>
+    int countErratic(std::index_sequence<I...>) const;
+    template <std::size_t... I>
+    void rechargeActive(std::index_sequence<I...>);
+    template <std::size_t... I>
+    int glowRange(bool largest, std::index_sequence<I...>) const;
+    void rechargeInactiveLumens();
+};
+
+// Pre-Condition: initial brightness, size, and power are positive
+// Post-Condition: lumen i is created from brightness + i, size + i and power + i * 10, like Nova's constructor
+template <int N>
+FixedNova<N>::FixedNova(int initialBrightness, int initialSize, int initialPower)
+: lumens(makeLumens(initialBrightness, initialSize, initialPower, Indices())) {}
+
+// Pre-Condition: nova holds exactly N lumens
+// Post-Condition: a FixedNova with the same lumens as nova is created
+template <int N>
+FixedNova<N>::FixedNova(const Nova& nova) : lumens(copyLumens(nova.bank(), Indices())) {}
+
+// Pre-Condition: x should be a non-negative integer and less than or equal to N
+// Post-Condition: The first x lumens are made to glow, and inactive lumens are recharged if necessary
+template <int N>
+void FixedNova<N>::glow(int x) {
+    if (x < 0 || x > N) {
+        throw std::out_of_range("Invalid number of lumens to glow.");
+    }
+    NovaMetrics::add(NovaCounter::NovaGlows);
+    NovaMetrics::add(NovaCounter::LumenGlows, x);
+    glowFirst(x, Indices());
+    rechargeInactiveLumens();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the minimum glow value among all lumens
+template <int N>
+int FixedNova<N>::minGlow() const {
+    return glowRange(false, Indices());
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the maximum glow value among all lumens
+template <int N>
+int FixedNova<N>::maxGlow() const {
+    return glowRange(true, Indices());
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of lumens, N
+template <int N>
+int FixedNova<N>::getNumLumens() const {
+    return N;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of active lumens
+template <int N>
+int FixedNova<N>::getNumActiveLumens() const {
+    return N - countInactive(Indices());
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic lumens
+template <int N>
+int FixedNova<N>::getNumErraticLumens() const {
+    return countErratic(Indices());
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic and dimmed lumens
+template <int N>
+int FixedNova<N>::getNumInactiveLumens() const {
+    return countInactive(Indices());
+}
+
+// Pre-Condition: 0 <= index < N
+// Post-Condition: Returns the current glow value of lumen index
+template <int N>
+int FixedNova<N>::currentGlowValue(int index) const {
+    return lumen(index).currentGlowValue();
+}
+
+// Pre-Condition: 0 <= index < N
+// Post-Condition: Returns lumen index, to glow, reset or recharge on its own
+template <int N>
+LumenCell& FixedNova<N>::lumen(int index) {
+    if (index < 0 || index >= N) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    return lumens[index];
+}
+
+// Pre-Condition: 0 <= index < N
+// Post-Condition: Returns lumen index for reading
+template <int N>
+const LumenCell& FixedNova<N>::lumen(int index) const {
+    if (index < 0 || index >= N) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    return lumens[index];
+}
+
+// Pre-Condition: luminate outlives the returned Nova
+// Post-Condition: Returns a Nova of N lumens in exactly the state of these lumens
+template <int N>
+Nova FixedNova<N>::toNova(ILuminosity* luminate) const {
+    Nova nova(luminate);
+    LumenBank& bank = nova.ownBank(N);
+    for (const LumenCell& cell : lumens) {
+        bank.append(cell.toLumen());
+    }
+    return nova;
+}
+
+// Pre-Condition: initial brightness, size, and power are positive
+// Post-Condition: Returns the N lumens of a new Nova with these initial values
+template <int N>
+template <std::size_t... I>
+std::array<LumenCell, N> FixedNova<N>::makeLumens(int initialBrightness, int initialSize, int initialPower,
+                                                  std::index_sequence<I...>) {
+    if (initialBrightness <= 0 || initialSize <= 0 || initialPower <= 0) {
+        throw std::out_of_range("All input values for Nova must be positive.");
+    }
+    return {{LumenCell(initialBrightness + static_cast<int>(I), initialSize + static_cast<int>(I),
+                       initialPower + static_cast<int>(I) * 10)...}};
+}
+
+// Pre-Condition: bank holds exactly N lumens
+// Post-Condition: Returns the lumens of bank as LumenCells
+template <int N>
+template <std::size_t... I>
+std::array<LumenCell, N> FixedNova<N>::copyLumens(const LumenBank& bank, std::index_sequence<I...>) {
+    if (bank.size() != N) {
+        throw std::out_of_range("The Nova does not hold the number of lumens of the FixedNova.");
+    }
+    return {{LumenCell(bank.lumenAt(static_cast<int>(I)))...}};
+}
+
+// Pre-Condition: 0 <= x <= N
+// Post-Condition: the first x lumens have glowed once
+template <int N>
+template <std::size_t... I>
+void FixedNova<N>::glowFirst(int x, std::index_sequence<I...>) {
+    ((static_cast<int>(I) < x ? static_cast<void>(lumens[I].glow()) : static_cast<void>(0)), ...);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of lumens that are not active
+template <int N>
+template <std::size_t... I>
+int FixedNova<N>::countInactive(std::index_sequence<I...>) const {
+    return (0 + ... + static_cast<int>(!lumens[I].isActive()));
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic lumens
+template <int N>
+template <std::size_t... I>
+int FixedNova<N>::countErratic(std::index_sequence<I...>) const {
+    return (0 + ... + static_cast<int>(lumens[I].isErratic()));
+}
+
+// Pre-Condition: None
+// Post-Condition: every active lumen is recharged
+template <int N>
+template <std::size_t... I>
+void FixedNova<N>::rechargeActive(std::index_sequence<I...>) {
+    ((lumens[I].isActive() ? lumens[I].recharge() : static_cast<void>(0)), ...);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the largest glow value if largest is true, otherwise the smallest
+template <int N>
+template <std::size_t... I>
+int FixedNova<N>::glowRange(bool largest, std::index_sequence<I...>) const {
+    int values[N] = {lumens[I].currentGlowValue()...};
+    int found = values[0];
+    ((found = (largest ? values[I] > found : values[I] < found) ? values[I] : found), ...);
+    return found;
+}
+
+// Pre-Condition: None
+// Post-Condition: Recharges active lumens if more than half of the lumens are inactive
+template <int N>
+void FixedNova<N>::rechargeInactiveLumens() {
+    if (countInactive(Indices()) > N / 2) {
+        NovaMetrics::add(NovaCounter::RechargeRounds);
+        rechargeActive(Indices());
+    }
+}
+
+#endif // FIXED_NOVA_H
+
+
+/*
+Class invariants for FixedNova:
+
+- A FixedNova always holds exactly N lumens, 1 <= N <= MAXFIXEDLUMENS, stored in lumens.
+- Every operation leaves its lumens in the same state as the same operation on a Nova with the
+  same lumens.
+*/
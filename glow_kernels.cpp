@@ -0,0 +1,371 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+Scalar and SIMD implementations of the batch glow kernels. The SIMD versions are compiled with
+per-function target attributes, so this file needs no special compiler flags and still runs on
+CPUs without the extensions: they are only called after the runtime check in glowKernels().
+
+A lumen is active when power > powerThreshold, erratic when it is not active and power > 0, and
+dimmed otherwise. The vector code computes all three glow values and blends them by those masks.
+
+ASSUMPTIONS:
+- The columns passed in hold at least end elements.
+- INACTIVESTATE is 0 and the erratic factor is 10, as in the Lumen class.
+- Products wrap around modulo 2^32, which is what the scalar Lumen code does on every
+  supported compiler; the scalar kernels use unsigned arithmetic to make that well-defined.
+*/
+
+#include "glow_kernels.h"
+#include <atomic>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GLOW_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr int INACTIVESTATE = 0;
+constexpr int ERRATICFACTOR = 10;
+
+/************************************* Scalar Kernels *********************************************/
+
+// Pre-Condition: columns hold lumen i
+// Post-Condition: returns currentGlowValue of lumen i
+inline int scalarGlowValue(const LumenColumns& c, int i) {
+    unsigned litValue = static_cast<unsigned>(c.brightness[i]) * static_cast<unsigned>(c.size[i]);
+    if (c.power[i] > c.powerThreshold[i]) {
+        return static_cast<int>(litValue);
+    }
+    if (c.power[i] > INACTIVESTATE) {
+        return static_cast<int>(litValue * static_cast<unsigned>(c.power[i] + ERRATICFACTOR));
+    }
+    return c.dimmingValue[i];
+}
+
+// Pre-Condition: lumen i has just glowed
+// Post-Condition: returns true if it was active or erratic before and is not active now
+inline bool scalarChanged(const LumenColumns& c, int i) {
+    int power = c.power[i];
+    int threshold = c.powerThreshold[i];
+    return power <= threshold && (power == threshold || power >= INACTIVESTATE);
+}
+
+int scalarGlowAndCollect(const LumenColumns& c, int begin, int end, int* changed) {
+    int found = 0;
+    for (int i = begin; i < end; i++) {
+        c.glowRequest[i]++;
+        c.power[i]--;
+        if (scalarChanged(c, i)) {
+            changed[found++] = i;
+        }
+    }
+    return found;
+}
+
+void scalarCurrentGlowValues(const LumenColumns& c, int begin, int end, int* glowValues) {
+    for (int i = begin; i < end; i++) {
+        glowValues[i - begin] = scalarGlowValue(c, i);
+    }
+}
+
+void scalarClassify(const LumenColumns& c, int begin, int end, LumenState* states) {
+    for (int i = begin; i < end; i++) {
+        if (c.power[i] > c.powerThreshold[i]) {
+            states[i - begin] = LumenState::Active;
+        } else if (c.power[i] > INACTIVESTATE) {
+            states[i - begin] = LumenState::Erratic;
+        } else {
+            states[i - begin] = LumenState::Dimmed;
+        }
+    }
+}
+
+const GlowKernels SCALARKERNELS = {
+    "scalar", scalarGlowAndCollect, scalarCurrentGlowValues, scalarClassify
+};
+
+#ifdef GLOW_KERNELS_X86
+
+/************************************* SSE4.2 Kernels *********************************************/
+
+#define SSE_TARGET __attribute__((target("sse4.2")))
+
+SSE_TARGET inline __m128i sseGlowValues(const LumenColumns& c, int i) {
+    __m128i brightness = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.brightness + i));
+    __m128i size = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.size + i));
+    __m128i power = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.power + i));
+    __m128i threshold = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.powerThreshold + i));
+    __m128i dimming = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.dimmingValue + i));
+
+    __m128i litValue = _mm_mullo_epi32(brightness, size);
+    __m128i erraticValue = _mm_mullo_epi32(litValue, _mm_add_epi32(power, _mm_set1_epi32(ERRATICFACTOR)));
+    __m128i active = _mm_cmpgt_epi32(power, threshold);
+    __m128i positive = _mm_cmpgt_epi32(power, _mm_set1_epi32(INACTIVESTATE));
+    __m128i inactiveValue = _mm_blendv_epi8(dimming, erraticValue, positive);
+    return _mm_blendv_epi8(inactiveValue, litValue, active);
+}
+
+SSE_TARGET int sseGlowAndCollect(const LumenColumns& c, int begin, int end, int* changed) {
+    const __m128i one = _mm_set1_epi32(1);
+    int found = 0;
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i* requests = reinterpret_cast<__m128i*>(c.glowRequest + i);
+        __m128i* powerSlot = reinterpret_cast<__m128i*>(c.power + i);
+        __m128i power = _mm_sub_epi32(_mm_loadu_si128(powerSlot), one);
+        _mm_storeu_si128(requests, _mm_add_epi32(_mm_loadu_si128(requests), one));
+        _mm_storeu_si128(powerSlot, power);
+
+        // changed: power <= threshold && power >= min(threshold, 0)
+        __m128i threshold = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.powerThreshold + i));
+        __m128i floor = _mm_min_epi32(threshold, _mm_set1_epi32(INACTIVESTATE));
+        __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(power, threshold), _mm_cmpgt_epi32(floor, power));
+        int bits = ~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF;
+        while (bits) {
+            changed[found++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+    return found + scalarGlowAndCollect(c, i, end, changed + found);
+}
+
+SSE_TARGET void sseCurrentGlowValues(const LumenColumns& c, int begin, int end, int* glowValues) {
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(glowValues + (i - begin)), sseGlowValues(c, i));
+    }
+    scalarCurrentGlowValues(c, i, end, glowValues + (i - begin));
+}
+
+SSE_TARGET void sseClassify(const LumenColumns& c, int begin, int end, LumenState* states) {
+    const __m128i one = _mm_set1_epi32(1);
+    int i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128i power = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.power + i));
+        __m128i threshold = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c.powerThreshold + i));
+        __m128i active = _mm_cmpgt_epi32(power, threshold);
+        __m128i positive = _mm_cmpgt_epi32(power, _mm_set1_epi32(INACTIVESTATE));
+        // inactive adds 1, inactive and not positive adds another 1
+        __m128i state = _mm_add_epi32(_mm_andnot_si128(active, one),
+                                      _mm_andnot_si128(active, _mm_andnot_si128(positive, one)));
+        __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(state, state), _mm_setzero_si128());
+        int packed = _mm_cvtsi128_si32(bytes);
+        std::memcpy(states + (i - begin), &packed, 4);
+    }
+    scalarClassify(c, i, end, states + (i - begin));
+}
+
+const GlowKernels SSEKERNELS = {
+    "sse4.2", sseGlowAndCollect, sseCurrentGlowValues, sseClassify
+};
+
+/************************************* AVX2 Kernels ***********************************************/
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+AVX2_TARGET inline __m256i avx2GlowValues(const LumenColumns& c, int i) {
+    __m256i brightness = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.brightness + i));
+    __m256i size = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.size + i));
+    __m256i power = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.power + i));
+    __m256i threshold = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.powerThreshold + i));
+    __m256i dimming = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.dimmingValue + i));
+
+    __m256i litValue = _mm256_mullo_epi32(brightness, size);
+    __m256i erraticValue = _mm256_mullo_epi32(litValue, _mm256_add_epi32(power, _mm256_set1_epi32(ERRATICFACTOR)));
+    __m256i active = _mm256_cmpgt_epi32(power, threshold);
+    __m256i positive = _mm256_cmpgt_epi32(power, _mm256_set1_epi32(INACTIVESTATE));
+    __m256i inactiveValue = _mm256_blendv_epi8(dimming, erraticValue, positive);
+    return _mm256_blendv_epi8(inactiveValue, litValue, active);
+}
+
+AVX2_TARGET int avx2GlowAndCollect(const LumenColumns& c, int begin, int end, int* changed) {
+    const __m256i one = _mm256_set1_epi32(1);
+    int found = 0;
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i* requests = reinterpret_cast<__m256i*>(c.glowRequest + i);
+        __m256i* powerSlot = reinterpret_cast<__m256i*>(c.power + i);
+        __m256i power = _mm256_sub_epi32(_mm256_loadu_si256(powerSlot), one);
+        _mm256_storeu_si256(requests, _mm256_add_epi32(_mm256_loadu_si256(requests), one));
+        _mm256_storeu_si256(powerSlot, power);
+
+        __m256i threshold = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.powerThreshold + i));
+        __m256i floor = _mm256_min_epi32(threshold, _mm256_set1_epi32(INACTIVESTATE));
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(power, threshold), _mm256_cmpgt_epi32(floor, power));
+        int bits = ~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF;
+        while (bits) {
+            changed[found++] = i + __builtin_ctz(bits);
+            bits &= bits - 1;
+        }
+    }
+    return found + scalarGlowAndCollect(c, i, end, changed + found);
+}
+
+AVX2_TARGET void avx2CurrentGlowValues(const LumenColumns& c, int begin, int end, int* glowValues) {
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(glowValues + (i - begin)), avx2GlowValues(c, i));
+    }
+    scalarCurrentGlowValues(c, i, end, glowValues + (i - begin));
+}
+
+AVX2_TARGET void avx2Classify(const LumenColumns& c, int begin, int end, LumenState* states) {
+    const __m256i one = _mm256_set1_epi32(1);
+    int i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256i power = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.power + i));
+        __m256i threshold = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(c.powerThreshold + i));
+        __m256i active = _mm256_cmpgt_epi32(power, threshold);
+        __m256i positive = _mm256_cmpgt_epi32(power, _mm256_set1_epi32(INACTIVESTATE));
+        __m256i state = _mm256_add_epi32(_mm256_andnot_si256(active, one),
+                                         _mm256_andnot_si256(active, _mm256_andnot_si256(positive, one)));
+        __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(state), _mm256_extracti128_si256(state, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(states + (i - begin)), _mm_packus_epi16(words, words));
+    }
+    scalarClassify(c, i, end, states + (i - begin));
+}
+
+const GlowKernels AVX2KERNELS = {
+    "avx2", avx2GlowAndCollect, avx2CurrentGlowValues, avx2Classify
+};
+
+/************************************* AVX-512 Kernels ********************************************/
+
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+AVX512_TARGET inline __m512i avx512GlowValues(const LumenColumns& c, int i) {
+    __m512i brightness = _mm512_loadu_si512(c.brightness + i);
+    __m512i size = _mm512_loadu_si512(c.size + i);
+    __m512i power = _mm512_loadu_si512(c.power + i);
+    __m512i threshold = _mm512_loadu_si512(c.powerThreshold + i);
+    __m512i dimming = _mm512_loadu_si512(c.dimmingValue + i);
+
+    __m512i litValue = _mm512_mullo_epi32(brightness, size);
+    __m512i erraticValue = _mm512_mullo_epi32(litValue, _mm512_add_epi32(power, _mm512_set1_epi32(ERRATICFACTOR)));
+    __mmask16 active = _mm512_cmpgt_epi32_mask(power, threshold);
+    __mmask16 positive = _mm512_cmpgt_epi32_mask(power, _mm512_set1_epi32(INACTIVESTATE));
+    __m512i inactiveValue = _mm512_mask_blend_epi32(positive, dimming, erraticValue);
+    return _mm512_mask_blend_epi32(active, inactiveValue, litValue);
+}
+
+AVX512_TARGET int avx512GlowAndCollect(const LumenColumns& c, int begin, int end, int* changed) {
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    int found = 0;
+    int i = begin;
+    for (; i + 16 <= end; i += 16) {
+        __m512i power = _mm512_sub_epi32(_mm512_loadu_si512(c.power + i), one);
+        _mm512_storeu_si512(c.glowRequest + i, _mm512_add_epi32(_mm512_loadu_si512(c.glowRequest + i), one));
+        _mm512_storeu_si512(c.power + i, power);
+
+        __m512i threshold = _mm512_loadu_si512(c.powerThreshold + i);
+        __m512i floor = _mm512_min_epi32(threshold, _mm512_set1_epi32(INACTIVESTATE));
+        __mmask16 hit = _mm512_cmple_epi32_mask(power, threshold) & _mm512_cmpge_epi32_mask(power, floor);
+        _mm512_mask_compressstoreu_epi32(changed + found, hit, _mm512_add_epi32(_mm512_set1_epi32(i), lanes));
+        found += __builtin_popcount(hit);
+    }
+    return found + scalarGlowAndCollect(c, i, end, changed + found);
+}
+
+AVX512_TARGET void avx512CurrentGlowValues(const LumenColumns& c, int begin, int end, int* glowValues) {
+    int i = begin;
+    for (; i + 16 <= end; i += 16) {
+        _mm512_storeu_si512(glowValues + (i - begin), avx512GlowValues(c, i));
+    }
+    scalarCurrentGlowValues(c, i, end, glowValues + (i - begin));
+}
+
+AVX512_TARGET void avx512Classify(const LumenColumns& c, int begin, int end, LumenState* states) {
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i one = _mm512_set1_epi32(1);
+    int i = begin;
+    for (; i + 16 <= end; i += 16) {
+        __m512i power = _mm512_loadu_si512(c.power + i);
+        __m512i threshold = _mm512_loadu_si512(c.powerThreshold + i);
+        __mmask16 inactive = _mm512_cmple_epi32_mask(power, threshold);
+        __mmask16 nonPositive = _mm512_cmple_epi32_mask(power, _mm512_set1_epi32(INACTIVESTATE));
+        __m512i state = _mm512_add_epi32(_mm512_mask_blend_epi32(inactive, zero, one),
+                                         _mm512_mask_blend_epi32(inactive & nonPositive, zero, one));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(states + (i - begin)), _mm512_cvtepi32_epi8(state));
+    }
+    scalarClassify(c, i, end, states + (i - begin));
+}
+
+const GlowKernels AVX512KERNELS = {
+    "avx512", avx512GlowAndCollect, avx512CurrentGlowValues, avx512Classify
+};
+
+#endif // GLOW_KERNELS_X86
+
+// Pre-Condition: name is one of the kernel set names
+// Post-Condition: returns the kernel set if this CPU supports it, otherwise nullptr
+const GlowKernels* supportedKernels(const char* name) {
+    if (std::strcmp(name, "scalar") == 0) {
+        return &SCALARKERNELS;
+    }
+#ifdef GLOW_KERNELS_X86
+    __builtin_cpu_init();
+    if (std::strcmp(name, "sse4.2") == 0 && __builtin_cpu_supports("sse4.2")) {
+        return &SSEKERNELS;
+    }
+    if (std::strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        return &AVX2KERNELS;
+    }
+    if (std::strcmp(name, "avx512") == 0 && __builtin_cpu_supports("avx512f")) {
+        return &AVX512KERNELS;
+    }
+#endif
+    return nullptr;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the widest kernel set this CPU supports
+const GlowKernels* detectKernels() {
+    const char* preference[] = {"avx512", "avx2", "sse4.2"};
+    for (const char* name : preference) {
+        if (const GlowKernels* kernels = supportedKernels(name)) {
+            return kernels;
+        }
+    }
+    return &SCALARKERNELS;
+}
+
+std::atomic<const GlowKernels*> activeKernels{nullptr};
+
+} // namespace
+
+// Pre-Condition: None
+// Post-Condition: returns the kernel set in use, detecting the CPU on the first call
+const GlowKernels& glowKernels() {
+    const GlowKernels* kernels = activeKernels.load(std::memory_order_acquire);
+    if (!kernels) {
+        kernels = detectKernels();
+        activeKernels.store(kernels, std::memory_order_release);
+    }
+    return *kernels;
+}
+
+// Pre-Condition: name is "scalar", "sse4.2", "avx2" or "avx512"
+// Post-Condition: that kernel set is used from now on and true is returned; false if this CPU cannot run it
+bool useGlowKernels(const char* name) {
+    const GlowKernels* kernels = supportedKernels(name);
+    if (!kernels) {
+        return false;
+    }
+    activeKernels.store(kernels, std::memory_order_release);
+    return true;
+}
+
+
+/*
+Implementation Invariant:
+- Every SIMD kernel processes whole vectors first and hands the remaining tail to the scalar
+  kernel, so short ranges and odd sizes take exactly the scalar path.
+- activeKernels is only ever set to one of the static kernel sets.
+*/
@@ -0,0 +1,64 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+GlowKernels.h declares the batch kernels that evaluate many lumens of a LumenBank at once:
+glow (reporting which lumens changed), current glow value and active/erratic classification.
+Each kernel exists in a scalar version and, on x86, in SSE4.2, AVX2 and AVX-512 versions that
+evaluate the three-way active / erratic / dimmed branch with compare-and-blend.
+The best version the CPU supports is picked once at runtime.
+
+Every version produces exactly the values the scalar Lumen member functions produce, including
+the 32-bit wrap-around of brightness * size * (power + 10).
+*/
+
+#ifndef GLOW_KERNELS_H
+#define GLOW_KERNELS_H
+
+// Column pointers of a LumenBank, as seen by the kernels
+struct LumenColumns {
+    int* brightness;
+    int* size;
+    int* power;
+    int* powerThreshold;
+    int* dimmingValue;
+    int* glowRequest;
+};
+
+enum class LumenState : unsigned char {
+    Active = 0,
+    Erratic = 1,
+    Dimmed = 2
+};
+
+struct GlowKernels {
+    const char* name;
+
+    // lumens [begin, end) glow once; the indices of the lumens whose glow value or state may
+    // have changed (they were active or erratic and are no longer active) go to changed,
+    // in increasing order. Returns how many were written; changed needs end - begin slots.
+    int (*glowAndCollect)(const LumenColumns& columns, int begin, int end, int* changed);
+
+    // glowValues[i - begin] = currentGlowValue of lumen i
+    void (*currentGlowValues)(const LumenColumns& columns, int begin, int end, int* glowValues);
+
+    // states[i - begin] = LumenState of lumen i
+    void (*classify)(const LumenColumns& columns, int begin, int end, LumenState* states);
+};
+
+const GlowKernels& glowKernels(); // best kernels for this CPU, detected on first use
+bool useGlowKernels(const char* name); // force "scalar", "sse4.2", "avx2" or "avx512"; false if unsupported
+
+#endif // GLOW_KERNELS_H
+
+
+/*
+Class invariants for GlowKernels:
+
+- Every function pointer is non-null.
+- For the same input columns, every kernel set writes identical results and leaves identical
+  power and glowRequest columns behind.
+*/
@@ -0,0 +1,310 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The GlowHeap class is an indexed binary heap stored flat in one array of (glow value, id)
+entries, with slot mapping every id back to its position. A changed value is moved with a hole:
+the entry is lifted out, the entries in its way shift by one level, and it is written once where
+it belongs. The GlowOrder class keeps one heap of each direction on the same values.
+
+first(k) walks the heap best first: a small frontier of positions, ordered like the heap, starts
+at the root; taking its best position hands out that entry and adds the entry's two children.
+The entries handed out are exactly the k first in order, and the frontier never holds more than
+k + 1 positions, so it costs O(k log k) however large the heap is.
+
+ASSUMPTIONS:
+- Ids are the dense lumen indices of one LumenBank.
+- update() is called for every change of a value; a value that did not change may be passed too.
+*/
+
+#include "glow_order.h"
+#include <algorithm>
+#include <stdexcept>
+
+/************************************** GlowHeap *************************************************/
+
+// Pre-Condition: None
+// Post-Condition: an empty heap is created; brightestFirst picks which end comes first
+GlowHeap::GlowHeap(bool brightestFirst) : brightestFirst(brightestFirst) {}
+
+// Pre-Condition: None
+// Post-Condition: id size() with value is in the heap
+void GlowHeap::add(int value) {
+    int id = size();
+    entries.push_back(LumenGlow{id, value});
+    slot.push_back(id);
+    siftUp(id);
+}
+
+// Pre-Condition: values holds n values, n >= 0
+// Post-Condition: ids size() .. size() + n - 1 with values[0 .. n - 1] are in the heap
+void GlowHeap::add(const int* values, int n) {
+    if (n <= size()) {
+        for (int i = 0; i < n; i++) {
+            add(values[i]);
+        }
+        return;
+    }
+    // more new entries than old ones: heapifying everything is cheaper than n sifts
+    int first = size();
+    entries.resize(first + n);
+    slot.resize(first + n);
+    for (int i = 0; i < n; i++) {
+        entries[first + i] = LumenGlow{first + i, values[i]};
+    }
+    heapify();
+}
+
+// Pre-Condition: the heap is not empty
+// Post-Condition: the id size() - 1 is no longer in the heap
+void GlowHeap::removeLast() {
+    if (entries.empty()) {
+        throw std::logic_error("GlowHeap has no id to remove.");
+    }
+    int last = size() - 1; // the id removed, and the last position of entries
+    int position = slot[last];
+    int moved = entries[last].index;
+    if (position != last) {
+        place(position, entries[last]);
+    }
+    entries.pop_back();
+    slot.pop_back();
+    if (position != last) {
+        siftUp(position);
+        siftDown(slot[moved]);
+    }
+}
+
+// Pre-Condition: 0 <= id < size()
+// Post-Condition: id has value, and the heap is in order again
+void GlowHeap::update(int id, int value) {
+    int position = slot[id];
+    int oldValue = entries[position].glowValue;
+    if (value == oldValue) {
+        return;
+    }
+    entries[position].glowValue = value;
+    // a value moving towards the top can only rise, one moving away from it can only sink
+    if ((value > oldValue) == brightestFirst) {
+        siftUp(position);
+    } else {
+        siftDown(position);
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the heap is empty; its capacity is kept
+void GlowHeap::clear() {
+    entries.clear();
+    slot.clear();
+}
+
+// Pre-Condition: values holds n values, n >= 0
+// Post-Condition: the heap holds exactly ids 0 .. n - 1 with values[0 .. n - 1]
+void GlowHeap::assign(const int* values, int n) {
+    entries.resize(n);
+    slot.resize(n);
+    for (int i = 0; i < n; i++) {
+        entries[i] = LumenGlow{i, values[i]};
+    }
+    heapify();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of ids in the heap
+int GlowHeap::size() const {
+    return entries.size();
+}
+
+// Pre-Condition: the heap is not empty
+// Post-Condition: Returns the value that comes first, O(1)
+int GlowHeap::topValue() const {
+    return entries[0].glowValue;
+}
+
+// Pre-Condition: k >= 0
+// Post-Condition: Returns the min(k, size()) entries that come first, in order, in O(k log k)
+std::vector<LumenGlow> GlowHeap::first(int k) const {
+    std::vector<LumenGlow> best;
+    k = std::min(k, size());
+    if (k <= 0) {
+        return best;
+    }
+    best.reserve(k);
+    std::vector<int> frontier{0};
+    frontier.reserve(k + 1);
+    // std heaps keep their largest element on top, so "larger" means "comes first" here
+    auto later = [this](int a, int b) { return before(entries[b], entries[a]); };
+    while (static_cast<int>(best.size()) < k) {
+        std::pop_heap(frontier.begin(), frontier.end(), later);
+        int position = frontier.back();
+        frontier.pop_back();
+        best.push_back(entries[position]);
+        for (int child = 2 * position + 1; child <= 2 * position + 2 && child < size(); child++) {
+            frontier.push_back(child);
+            std::push_heap(frontier.begin(), frontier.end(), later);
+        }
+    }
+    return best;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if a comes before b in this heap's order
+bool GlowHeap::before(const LumenGlow& a, const LumenGlow& b) const {
+    if (a.glowValue != b.glowValue) {
+        return brightestFirst ? a.glowValue > b.glowValue : a.glowValue < b.glowValue;
+    }
+    return a.index < b.index;
+}
+
+// Pre-Condition: 0 <= position < size()
+// Post-Condition: entry sits at position and its slot says so
+void GlowHeap::place(int position, const LumenGlow& entry) {
+    entries[position] = entry;
+    slot[entry.index] = position;
+}
+
+// Pre-Condition: 0 <= position < size(); only the entry at position may come before its parent
+// Post-Condition: the heap is in order
+void GlowHeap::siftUp(int position) {
+    LumenGlow entry = entries[position];
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (!before(entry, entries[parent])) {
+            break;
+        }
+        place(position, entries[parent]);
+        position = parent;
+    }
+    place(position, entry);
+}
+
+// Pre-Condition: 0 <= position < size(); only the entry at position may come after a child
+// Post-Condition: the heap is in order
+void GlowHeap::siftDown(int position) {
+    int n = size();
+    LumenGlow entry = entries[position];
+    for (int child = 2 * position + 1; child < n; child = 2 * position + 1) {
+        if (child + 1 < n && before(entries[child + 1], entries[child])) {
+            child++;
+        }
+        if (!before(entries[child], entry)) {
+            break;
+        }
+        place(position, entries[child]);
+        position = child;
+    }
+    place(position, entry);
+}
+
+// Pre-Condition: entries holds one entry per id 0 .. size() - 1, in any order
+// Post-Condition: the heap is in order and every slot is set, in O(size())
+void GlowHeap::heapify() {
+    int n = size();
+    for (int position = 0; position < n; position++) {
+        slot[entries[position].index] = position;
+    }
+    for (int position = n / 2 - 1; position >= 0; position--) {
+        siftDown(position);
+    }
+}
+
+/************************************** GlowOrder ************************************************/
+
+// Pre-Condition: None
+// Post-Condition: an empty order is created
+GlowOrder::GlowOrder() : brightest(true), dimmest(false) {}
+
+// Pre-Condition: None
+// Post-Condition: id size() with value is in the order
+void GlowOrder::add(int value) {
+    brightest.add(value);
+    dimmest.add(value);
+}
+
+// Pre-Condition: values holds n values, n >= 0
+// Post-Condition: ids size() .. size() + n - 1 with values[0 .. n - 1] are in the order
+void GlowOrder::add(const int* values, int n) {
+    brightest.add(values, n);
+    dimmest.add(values, n);
+}
+
+// Pre-Condition: the order is not empty
+// Post-Condition: the id size() - 1 is no longer in the order
+void GlowOrder::removeLast() {
+    brightest.removeLast();
+    dimmest.removeLast();
+}
+
+// Pre-Condition: 0 <= id < size()
+// Post-Condition: id has value, O(log size())
+void GlowOrder::update(int id, int value) {
+    brightest.update(id, value);
+    dimmest.update(id, value);
+}
+
+// Pre-Condition: None
+// Post-Condition: the order is empty
+void GlowOrder::clear() {
+    brightest.clear();
+    dimmest.clear();
+}
+
+// Pre-Condition: values holds n values, n >= 0
+// Post-Condition: the order holds exactly ids 0 .. n - 1 with values[0 .. n - 1], built in O(n)
+void GlowOrder::assign(const int* values, int n) {
+    brightest.assign(values, n);
+    dimmest.assign(values, n);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of ids in the order
+int GlowOrder::size() const {
+    return brightest.size();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the order holds no ids
+bool GlowOrder::empty() const {
+    return size() == 0;
+}
+
+// Pre-Condition: the order is not empty
+// Post-Condition: Returns the smallest value, O(1)
+int GlowOrder::minValue() const {
+    return dimmest.topValue();
+}
+
+// Pre-Condition: the order is not empty
+// Post-Condition: Returns the largest value, O(1)
+int GlowOrder::maxValue() const {
+    return brightest.topValue();
+}
+
+// Pre-Condition: k >= 0
+// Post-Condition: Returns the min(k, size()) ids with the largest values, largest first, ties by id
+std::vector<LumenGlow> GlowOrder::largest(int k) const {
+    return brightest.first(k);
+}
+
+// Pre-Condition: k >= 0
+// Post-Condition: Returns the min(k, size()) ids with the smallest values, smallest first, ties by id
+std::vector<LumenGlow> GlowOrder::smallest(int k) const {
+    return dimmest.first(k);
+}
+
+
+/*
+Implementation Invariant:
+- Every change to entries goes through place(), which keeps slot in step, so slot is always the
+  inverse of entries.
+- update() moves the entry in the one direction its value moved: an entry that now comes earlier
+  cannot have to sink below its children, and one that now comes later cannot have to rise.
+- removeLast() fills the freed position with the last entry, which may have to move either way,
+  so it is sifted both up and down; at most one of the two moves it.
+- first() only adds a position after its parent was handed out, and a heap parent always comes
+  before its children, so the frontier's best position is the next entry in order.
+*/
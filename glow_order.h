@@ -0,0 +1,95 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+GlowOrder.h is the header file for the GlowOrder class, which keeps the current glow values of a
+group of lumens (ids 0 .. size() - 1) in order. It holds two flat binary heaps of (glow value, id)
+entries, one with the brightest lumen on top and one with the dimmest, and every id knows its
+slot in each heap. The smallest and largest value are the two tops, O(1); changing, adding or
+dropping a value moves one entry up or down each heap, O(log n), whichever way the value moved.
+The k brightest or dimmest lumens are read off the heap best first in O(k log k).
+
+GlowHeap is one of those heaps. Of two lumens with the same glow value the lower id comes first,
+so the order is total and every answer is deterministic.
+*/
+
+#ifndef GLOW_ORDER_H
+#define GLOW_ORDER_H
+
+#include "small_vector.h"
+#include <vector>
+
+// One lumen of a brightest / dimmest answer
+struct LumenGlow {
+    int index;
+    int glowValue;
+};
+
+class GlowHeap {
+public:
+    explicit GlowHeap(bool brightestFirst);
+
+    void add(int value); // the new id is the old size()
+    void add(const int* values, int n); // ids size() .. size() + n - 1, in one pass when n is large
+    void removeLast(); // drops the id size() - 1
+    void update(int id, int value);
+    void clear();
+    void assign(const int* values, int n); // ids 0 .. n - 1, heapified in O(n)
+
+    int size() const;
+    int topValue() const;
+    std::vector<LumenGlow> first(int k) const; // the min(k, size()) first lumens, in order
+
+private:
+    static constexpr int INLINEIDS = 16; // ids held without allocating, as many as an inline LumenBank holds
+
+    SmallVector<LumenGlow, INLINEIDS> entries; // the heap, entries[0] comes first
+    SmallVector<int, INLINEIDS> slot; // slot[id] = position of id in entries
+    bool brightestFirst;
+
+    bool before(const LumenGlow& a, const LumenGlow& b) const;
+    void place(int position, const LumenGlow& entry);
+    void siftUp(int position);
+    void siftDown(int position);
+    void heapify();
+};
+
+class GlowOrder {
+public:
+    GlowOrder();
+
+    void add(int value);
+    void add(const int* values, int n);
+    void removeLast();
+    void update(int id, int value);
+    void clear();
+    void assign(const int* values, int n);
+
+    int size() const;
+    bool empty() const;
+    int minValue() const; // the group is not empty
+    int maxValue() const; // the group is not empty
+    std::vector<LumenGlow> largest(int k) const; // largest value first, ties by id
+    std::vector<LumenGlow> smallest(int k) const; // smallest value first, ties by id
+
+private:
+    GlowHeap brightest;
+    GlowHeap dimmest;
+};
+
+#endif // GLOW_ORDER_H
+
+
+/*
+Class invariants for GlowHeap:
+
+- entries and slot have size() entries; slot[entries[p].index] == p for every position p.
+- No entry comes after its children: before(entries[(p - 1) / 2], entries[p]) for every p > 0.
+
+Class invariants for GlowOrder:
+
+- brightest and dimmest hold the same (id, glow value) pairs, one per id 0 .. size() - 1.
+*/
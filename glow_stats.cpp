@@ -0,0 +1,232 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The GlowStats class keys a value by its magnitude: magnitudes below EXACTLIMIT are their own
+key, larger ones use the position of their highest set bit and the SUBBUCKETBITS bits below it,
+the same split HdrHistogram uses. Non-negative values count upwards from the middle of counts
+and negative values downwards, so walking counts from the front visits the values in order.
+
+ASSUMPTIONS:
+- Sums of glow values fit in 64 bits.
+*/
+
+#include "glow_stats.h"
+#include <climits>
+#include <cmath>
+#include <stdexcept>
+
+// Pre-Condition: None
+// Post-Condition: empty statistics are created
+GlowStats::GlowStats() : total(0), valueSum(0), minValue(INT_MAX), maxValue(INT_MIN), counts(NUMBUCKETS, 0) {}
+
+// Pre-Condition: None
+// Post-Condition: value is counted in every statistic
+void GlowStats::add(int value) {
+    add(&value, 1);
+}
+
+// Pre-Condition: values holds n ints
+// Post-Condition: every value is counted in every statistic
+void GlowStats::add(const int* values, int n) {
+    long long blockSum = 0;
+    int blockMin = minValue;
+    int blockMax = maxValue;
+    for (int i = 0; i < n; i++) {
+        int value = values[i];
+        blockSum += value;
+        blockMin = value < blockMin ? value : blockMin;
+        blockMax = value > blockMax ? value : blockMax;
+        counts[bucketOf(value)]++;
+    }
+    total += n;
+    valueSum += blockSum;
+    minValue = blockMin;
+    maxValue = blockMax;
+}
+
+// Pre-Condition: None
+// Post-Condition: these statistics also count every value counted by other
+void GlowStats::merge(const GlowStats& other) {
+    if (other.total == 0) {
+        return;
+    }
+    for (int b = 0; b < NUMBUCKETS; b++) {
+        counts[b] += other.counts[b];
+    }
+    total += other.total;
+    valueSum += other.valueSum;
+    minValue = other.minValue < minValue ? other.minValue : minValue;
+    maxValue = other.maxValue > maxValue ? other.maxValue : maxValue;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of values counted
+long long GlowStats::count() const {
+    return total;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the sum of the values counted
+long long GlowStats::sum() const {
+    return valueSum;
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns the mean of the values counted
+double GlowStats::mean() const {
+    if (total == 0) {
+        throw std::runtime_error("No glow values in the statistics.");
+    }
+    return static_cast<double>(valueSum) / static_cast<double>(total);
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns the smallest value counted
+int GlowStats::min() const {
+    if (total == 0) {
+        throw std::runtime_error("No glow values in the statistics.");
+    }
+    return minValue;
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns the largest value counted
+int GlowStats::max() const {
+    if (total == 0) {
+        throw std::runtime_error("No glow values in the statistics.");
+    }
+    return maxValue;
+}
+
+// Pre-Condition: at least one value was counted; 0 <= q <= 1
+// Post-Condition: Returns the value of nearest rank ceil(q * count()), read from its histogram
+//                 bucket: exact for |v| < 128, otherwise within 1/128 of the true value
+int GlowStats::percentile(double q) const {
+    if (total == 0) {
+        throw std::runtime_error("No glow values in the statistics.");
+    }
+    if (!(q >= 0.0 && q <= 1.0)) {
+        throw std::out_of_range("Invalid percentile.");
+    }
+    long long rank = static_cast<long long>(std::ceil(q * static_cast<double>(total)));
+    if (rank <= 1) {
+        return minValue;
+    }
+    if (rank >= total) {
+        return maxValue;
+    }
+
+    long long seen = 0;
+    int b = bucketOf(minValue);
+    while (seen + counts[b] < rank) {
+        seen += counts[b];
+        b++;
+    }
+    // the middle of the bucket, but never outside the values actually seen
+    long long estimate = (bucketLower(b) + bucketUpper(b)) / 2;
+    if (estimate < minValue) {
+        return minValue;
+    }
+    return estimate > maxValue ? maxValue : static_cast<int>(estimate);
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns the median, as percentile(0.50)
+int GlowStats::p50() const {
+    return percentile(0.50);
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns percentile(0.95)
+int GlowStats::p95() const {
+    return percentile(0.95);
+}
+
+// Pre-Condition: at least one value was counted
+// Post-Condition: Returns percentile(0.99)
+int GlowStats::p99() const {
+    return percentile(0.99);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns every non-empty histogram bucket, lowest values first
+std::vector<GlowHistogramBucket> GlowStats::histogram() const {
+    std::vector<GlowHistogramBucket> buckets;
+    for (int b = 0; b < NUMBUCKETS; b++) {
+        if (counts[b] != 0) {
+            buckets.push_back(GlowHistogramBucket{bucketLower(b), bucketUpper(b), counts[b]});
+        }
+    }
+    return buckets;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the key of magnitude, 0 <= key < MAGNITUDEKEYS; keys grow with magnitude
+int GlowStats::magnitudeKey(unsigned magnitude) {
+    if (magnitude < static_cast<unsigned>(EXACTLIMIT)) {
+        return static_cast<int>(magnitude);
+    }
+    int highBit = 31 - __builtin_clz(magnitude);
+    int shift = highBit - SUBBUCKETBITS;
+    return ((shift + 1) << SUBBUCKETBITS) + static_cast<int>((magnitude >> shift) & ((1u << SUBBUCKETBITS) - 1));
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the histogram bucket of value
+int GlowStats::bucketOf(int value) {
+    if (value >= 0) {
+        return MAGNITUDEKEYS - 1 + magnitudeKey(static_cast<unsigned>(value));
+    }
+    return MAGNITUDEKEYS - 1 - magnitudeKey(0u - static_cast<unsigned>(value));
+}
+
+// Pre-Condition: 0 <= key < MAGNITUDEKEYS
+// Post-Condition: Returns the smallest magnitude with this key
+long long GlowStats::magnitudeLower(int key) {
+    if (key < EXACTLIMIT) {
+        return key;
+    }
+    int shift = (key >> SUBBUCKETBITS) - 1;
+    long long subBucket = key & ((1 << SUBBUCKETBITS) - 1);
+    return ((1LL << SUBBUCKETBITS) + subBucket) << shift;
+}
+
+// Pre-Condition: 0 <= key < MAGNITUDEKEYS
+// Post-Condition: Returns the largest magnitude with this key
+long long GlowStats::magnitudeUpper(int key) {
+    if (key < EXACTLIMIT) {
+        return key;
+    }
+    int shift = (key >> SUBBUCKETBITS) - 1;
+    return magnitudeLower(key) + (1LL << shift) - 1;
+}
+
+// Pre-Condition: 0 <= bucket < NUMBUCKETS
+// Post-Condition: Returns the smallest value counted in bucket
+long long GlowStats::bucketLower(int bucket) {
+    int key = bucket - (MAGNITUDEKEYS - 1);
+    return key >= 0 ? magnitudeLower(key) : -magnitudeUpper(-key);
+}
+
+// Pre-Condition: 0 <= bucket < NUMBUCKETS
+// Post-Condition: Returns the largest value counted in bucket
+long long GlowStats::bucketUpper(int bucket) {
+    int key = bucket - (MAGNITUDEKEYS - 1);
+    return key >= 0 ? magnitudeUpper(key) : -magnitudeLower(-key);
+}
+
+
+/*
+Implementation Invariant:
+- magnitudeKey() is monotonic and magnitudeLower() / magnitudeUpper() are its exact inverse, so
+  bucket b holds exactly the values in [bucketLower(b), bucketUpper(b)] and the buckets cover
+  every int without gaps or overlap.
+- A bucket above EXACTLIMIT spans 2^shift values that all have 2^(shift + SUBBUCKETBITS) or
+  more as magnitude, so its middle is within 1/128 of every value in it.
+- Histogram buckets of negative values that no int can reach (magnitudes above 2^31) simply
+  stay empty.
+*/
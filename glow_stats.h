@@ -0,0 +1,81 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+GlowStats.h is the header file for the GlowStats class, the summary of a set of glow values
+that Nova::glowStats() fills in one pass over the lumens: count, sum, mean, min, max, a
+histogram and approximate percentiles (p50, p95, p99 or any other).
+
+The histogram has fixed log-linear buckets: every value with |v| < 128 has a bucket of its own,
+and every power of two above that is split into 64 equal buckets, so a bucket is never wider
+than 1/64 of the values in it. Percentiles are read from the histogram and are within 1/128 of
+the true value (exact for |v| < 128, and for the min and max). Because the buckets are the same
+for every GlowStats, the stats of several Novas merge by adding bucket counts, which is how
+NovaEngine builds fleet-wide statistics.
+*/
+
+#ifndef GLOW_STATS_H
+#define GLOW_STATS_H
+
+#include <vector>
+
+// One non-empty histogram bucket: count values v with lower <= v <= upper
+struct GlowHistogramBucket {
+    long long lower;
+    long long upper;
+    long long count;
+};
+
+class GlowStats {
+public:
+    GlowStats();
+
+    void add(int value);
+    void add(const int* values, int n); // every statistic updated in one pass over values
+    void merge(const GlowStats& other);
+
+    long long count() const;
+    long long sum() const;
+    double mean() const;
+    int min() const;
+    int max() const;
+    int percentile(double q) const; // 0 <= q <= 1, nearest rank, within 1/128 of the true value
+    int p50() const;
+    int p95() const;
+    int p99() const;
+    std::vector<GlowHistogramBucket> histogram() const; // non-empty buckets, lowest first
+
+private:
+    static constexpr int SUBBUCKETBITS = 6; // 64 buckets per power of two
+    static constexpr int EXACTLIMIT = 2 << SUBBUCKETBITS; // |v| below this has its own bucket
+    static constexpr int MAGNITUDEKEYS = (32 - SUBBUCKETBITS + 1) << SUBBUCKETBITS; // buckets for 0 .. 2^32 - 1
+    static constexpr int NUMBUCKETS = 2 * MAGNITUDEKEYS - 1; // negative and non-negative values
+
+    long long total;
+    long long valueSum;
+    int minValue;
+    int maxValue;
+    std::vector<long long> counts; // NUMBUCKETS buckets, lowest values first
+
+    static int magnitudeKey(unsigned magnitude);
+    static int bucketOf(int value);
+    static long long magnitudeLower(int key);
+    static long long magnitudeUpper(int key);
+    static long long bucketLower(int bucket);
+    static long long bucketUpper(int bucket);
+};
+
+#endif // GLOW_STATS_H
+
+
+/*
+Class invariants for GlowStats:
+
+- counts has NUMBUCKETS entries that add up to total; the bucket of a value only depends on
+  the value, never on the other values.
+- When total > 0, minValue and maxValue are the smallest and largest value added, and valueSum
+  their sum; when total == 0 the readers throw instead of reporting them.
+*/
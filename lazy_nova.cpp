@@ -0,0 +1,339 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The LazyNova class answers every query from three sources: the dense prefix bank, the sparse
+map of touched lumens, and the formula for the untouched ones. Untouched lumens are always
+active, so the state counts only come from the stored lumens.
+
+The glow value of untouched lumen i is (brightness + i) * (size + i) taken modulo 2^32 as an
+int, like the batch kernels compute it. The 64-bit product grows with i, so the untouched lumens
+split into windows in which it stays within one 2^32 range and the int value grows with i as
+well; in each window the smallest value is at the first untouched lumen and the largest at the
+last. As long as no glow value passes 2^31 there is a single window.
+
+ASSUMPTIONS:
+- Lumens are only touched through glow, glowLumen, resetLumen and rechargeLumen.
+*/
+
+#include "lazy_nova.h"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+constexpr unsigned long long WRAPHALF = 1ULL << 31; // an int holds [-WRAPHALF, WRAPHALF)
+}
+
+// Pre-Condition: initial brightness, size, power and numLumens are positive, and the values of
+//                the last lumen still fit in an int
+// Post-Condition: a Nova of numLumens untouched lumens is created without storing any of them
+LazyNova::LazyNova(int initialBrightness, int initialSize, int initialPower, int numLumens)
+: initialBrightness(initialBrightness), initialSize(initialSize), initialPower(initialPower),
+  numLumens(numLumens), untouchedCharged(false), touchedErratic(0), touchedDimmed(0) {
+    if (initialBrightness <= 0 || initialSize <= 0 || initialPower <= 0 || numLumens <= 0) {
+        throw std::out_of_range("All input values for Nova must be positive.");
+    }
+    int last = numLumens - 1;
+    if (initialBrightness > INT_MAX - last || initialSize > INT_MAX - last || last > (INT_MAX - initialPower) / 10) {
+        throw std::out_of_range("The lumen values of the Nova do not fit in an int.");
+    }
+}
+
+// Pre-Condition: x should be a non-negative integer and less than or equal to the number of lumens
+// Post-Condition: The first x lumens are made to glow, and inactive lumens are recharged if necessary
+void LazyNova::glow(int x) {
+    if (x < 0 || x > numLumens) {
+        throw std::out_of_range("Invalid number of lumens to glow.");
+    }
+    NovaMetrics::add(NovaCounter::NovaGlows);
+    extendPrefix(x);
+    prefix.glowFirst(x);
+    rechargeInactiveLumens();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the minimum glow value among all lumens
+int LazyNova::minGlow() const {
+    int low = INT_MAX;
+    int high = INT_MIN;
+    bool found = false;
+    untouchedRange(low, high, found);
+    if (prefix.size() > 0) {
+        low = std::min(low, prefix.minGlowValue());
+    }
+    for (const std::pair<const int, LumenCell>& entry : touched) {
+        low = std::min(low, entry.second.currentGlowValue());
+    }
+    return low;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the maximum glow value among all lumens
+int LazyNova::maxGlow() const {
+    int low = INT_MAX;
+    int high = INT_MIN;
+    bool found = false;
+    untouchedRange(low, high, found);
+    if (prefix.size() > 0) {
+        high = std::max(high, prefix.maxGlowValue());
+    }
+    for (const std::pair<const int, LumenCell>& entry : touched) {
+        high = std::max(high, entry.second.currentGlowValue());
+    }
+    return high;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of lumens, stored or not
+int LazyNova::getNumLumens() const {
+    return numLumens;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of active lumens
+int LazyNova::getNumActiveLumens() const {
+    return numLumens - getNumInactiveLumens();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic lumens
+int LazyNova::getNumErraticLumens() const {
+    return prefix.countErratic() + touchedErratic;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic and dimmed lumens
+int LazyNova::getNumInactiveLumens() const {
+    return prefix.countInactive() + touchedErratic + touchedDimmed;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: Returns the current glow value of lumen index, without storing it
+int LazyNova::currentGlowValue(int index) const {
+    if (index < 0 || index >= numLumens) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    if (index < prefix.size()) {
+        return prefix.currentGlowValue(index);
+    }
+    std::map<int, LumenCell>::const_iterator stored = touched.find(index);
+    if (stored != touched.end()) {
+        return stored->second.currentGlowValue();
+    }
+    return static_cast<int>(static_cast<unsigned>(untouchedValue(index)));
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: lumen index has glowed once, like Nova::lumen(index).glow(); returns its glow value
+int LazyNova::glowLumen(int index) {
+    if (index < 0 || index >= numLumens) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    if (index < prefix.size()) {
+        return prefix.glow(index);
+    }
+    LumenCell& lumen = touchLumen(index);
+    countTouched(lumen, -1);
+    int glowValue = lumen.glow();
+    countTouched(lumen, 1);
+    NovaMetrics::add(NovaCounter::LumenGlows);
+    return glowValue;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: lumen index is reset like Nova::lumen(index).reset(); returns true if it was reset
+bool LazyNova::resetLumen(int index) {
+    if (index < 0 || index >= numLumens) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    if (index < prefix.size()) {
+        return prefix.reset(index);
+    }
+    LumenCell& lumen = touchLumen(index);
+    countTouched(lumen, -1);
+    bool wasReset = lumen.reset();
+    countTouched(lumen, 1);
+    return wasReset;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: lumen index is recharged like Nova::lumen(index).recharge()
+void LazyNova::rechargeLumen(int index) {
+    if (index < 0 || index >= numLumens) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    if (index < prefix.size()) {
+        prefix.recharge(index);
+        return;
+    }
+    LumenCell& lumen = touchLumen(index);
+    countTouched(lumen, -1);
+    lumen.recharge();
+    countTouched(lumen, 1);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of lumens held in memory
+int LazyNova::getNumStoredLumens() const {
+    return prefix.size() + static_cast<int>(touched.size());
+}
+
+// Pre-Condition: luminate outlives the returned Nova
+// Post-Condition: Returns a Nova holding every lumen of this LazyNova, in the same state
+Nova LazyNova::toNova(ILuminosity* luminate) const {
+    Nova nova(luminate);
+    LumenBank lumens(prefix);
+    std::map<int, LumenCell>::const_iterator next = touched.begin();
+    int begin = prefix.size();
+    lumens.appendGenerated(numLumens - begin, [this, &next, begin](int k) {
+        int index = begin + k;
+        if (next != touched.end() && next->first == index) {
+            return (next++)->second.toLumen();
+        }
+        return untouchedLumen(index).toLumen();
+    });
+    nova.adoptBank(std::move(lumens));
+    return nova;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: Returns lumen index as Nova's constructor builds it, recharged if untouchedCharged
+LumenCell LazyNova::untouchedLumen(int index) const {
+    LumenCell lumen(initialBrightness + index, initialSize + index, initialPower + index * 10);
+    if (untouchedCharged) {
+        lumen.recharge();
+    }
+    return lumen;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: Returns brightness * size of untouched lumen index, before it is wrapped to an int
+unsigned long long LazyNova::untouchedValue(int index) const {
+    return static_cast<unsigned long long>(initialBrightness + index) *
+           static_cast<unsigned long long>(initialSize + index);
+}
+
+// Pre-Condition: 0 <= begin <= end <= getNumLumens()
+// Post-Condition: Returns the first index in [begin, end) whose untouchedValue is at least value, or end
+int LazyNova::firstIndexReaching(int begin, int end, unsigned long long value) const {
+    while (begin < end) {
+        int middle = begin + (end - begin) / 2;
+        if (untouchedValue(middle) >= value) {
+            end = middle;
+        } else {
+            begin = middle + 1;
+        }
+    }
+    return begin;
+}
+
+// Pre-Condition: None
+// Post-Condition: low and high also cover the glow values of the untouched lumens; found is set
+//                 if there is at least one
+void LazyNova::untouchedRange(int& low, int& high, bool& found) const {
+    std::map<int, LumenCell>::const_iterator next = touched.begin();
+    int begin = prefix.size();
+    while (begin < numLumens) {
+        // [begin, end): the lumens whose value wraps to an int by the same multiple of 2^32
+        unsigned long long window = (untouchedValue(begin) + WRAPHALF) >> 32;
+        int end = firstIndexReaching(begin, numLumens, (window << 32) + WRAPHALF);
+
+        int first = begin;
+        while (next != touched.end() && next->first < end && next->first == first) {
+            ++next;
+            ++first;
+        }
+        if (first < end) {
+            int last = end - 1;
+            std::map<int, LumenCell>::const_iterator after = touched.upper_bound(last);
+            while (after != touched.begin() && std::prev(after)->first == last) {
+                --after;
+                --last;
+            }
+            low = std::min(low, static_cast<int>(static_cast<unsigned>(untouchedValue(first))));
+            high = std::max(high, static_cast<int>(static_cast<unsigned>(untouchedValue(last))));
+            found = true;
+        }
+        while (next != touched.end() && next->first < end) {
+            ++next;
+        }
+        begin = end;
+    }
+}
+
+// Pre-Condition: 0 <= end <= getNumLumens()
+// Post-Condition: lumens [0, end) are stored in the prefix; touched lumens below end moved into it
+void LazyNova::extendPrefix(int end) {
+    int begin = prefix.size();
+    if (end <= begin) {
+        return;
+    }
+    std::map<int, LumenCell>::iterator first = touched.begin();
+    std::map<int, LumenCell>::iterator last = touched.lower_bound(end);
+    std::map<int, LumenCell>::iterator next = first;
+    prefix.appendGenerated(end - begin, [this, &next, last, begin](int k) {
+        int index = begin + k;
+        if (next != last && next->first == index) {
+            return (next++)->second.toLumen();
+        }
+        return untouchedLumen(index).toLumen();
+    });
+    for (std::map<int, LumenCell>::iterator moved = first; moved != last; ++moved) {
+        countTouched(moved->second, -1);
+    }
+    touched.erase(first, last);
+}
+
+// Pre-Condition: prefix.size() <= index < getNumLumens()
+// Post-Condition: Returns lumen index from the sparse map, adding it untouched if it is not there
+LumenCell& LazyNova::touchLumen(int index) {
+    std::map<int, LumenCell>::iterator stored = touched.lower_bound(index);
+    if (stored == touched.end() || stored->first != index) {
+        stored = touched.emplace_hint(stored, index, untouchedLumen(index));
+        countTouched(stored->second, 1);
+    }
+    return stored->second;
+}
+
+// Pre-Condition: lumen is in touched
+// Post-Condition: the erratic and dimmed counts of touched include lumen delta more times
+void LazyNova::countTouched(const LumenCell& lumen, int delta) {
+    if (lumen.isErratic()) {
+        touchedErratic += delta;
+    } else if (!lumen.isActive()) {
+        touchedDimmed += delta;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: Recharges active lumens if more than half of the lumens are inactive
+void LazyNova::rechargeInactiveLumens() {
+    if (getNumInactiveLumens() <= numLumens / 2) {
+        return;
+    }
+    NovaMetrics::add(NovaCounter::RechargeRounds);
+    prefix.rechargeActive();
+    for (std::pair<const int, LumenCell>& entry : touched) {
+        if (entry.second.isActive()) {
+            entry.second.recharge();
+        }
+    }
+    // untouched lumens are active, and recharging only sets charged on them
+    untouchedCharged = true;
+}
+
+
+/*
+Implementation Invariant:
+- An untouched lumen has power = powerCopy > powerThreshold, so it is active; a recharge round
+  leaves its values alone and only sets charged, which untouchedCharged records for all of them.
+- The keys of touched only grow past the prefix: extendPrefix() moves every touched lumen below
+  the new prefix end into the prefix before the prefix is used.
+- untouchedRange() visits the windows in increasing order and each touched lumen at most a
+  constant number of times, besides one binary search per window.
+*/
@@ -0,0 +1,85 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+LazyNova.h is the header file for the LazyNova class, a Nova whose lumens are only stored once
+they are touched. Nova's constructor builds lumen i from brightness + i, size + i and
+power + i * 10, and until lumen i is glowed, reset or recharged its state follows from i and
+those three values alone. A LazyNova keeps the three values and stores:
+- the lumens glow(x) has reached, as a dense LumenBank prefix [0, x);
+- lumens past the prefix touched one at a time (glowLumen, resetLumen, rechargeLumen), in a
+  sparse map from index to LumenCell.
+Every other lumen is untouched and answered from the formula, so construction is O(1) and
+memory grows with the number of lumens actually touched.
+
+An untouched lumen is always active and glows with (brightness + i) * (size + i), which grows
+with i. min/max over the untouched lumens therefore only look at the ends of each run of
+untouched lumens, without visiting the lumens in between.
+*/
+
+#ifndef LAZY_NOVA_H
+#define LAZY_NOVA_H
+
+#include <map>
+#include "lumen_cell.h"
+#include "lumen_bank.h"
+#include "nova.h"
+
+class LazyNova final : public INova {
+public:
+    LazyNova(int initialBrightness, int initialSize, int initialPower, int numLumens); // O(1)
+
+    void glow(int x) override; // stores the first x lumens if they are not stored yet
+    int minGlow() const override; // O(touched lumens) while no glow value wraps past 2^31
+    int maxGlow() const override;
+    int getNumLumens() const override;
+    int getNumActiveLumens() const override;
+    int getNumErraticLumens() const override;
+    int getNumInactiveLumens() const override;
+    int currentGlowValue(int index) const override;
+
+    // Per-element operations; only lumen index is stored, not the lumens before it
+    int glowLumen(int index);
+    bool resetLumen(int index);
+    void rechargeLumen(int index);
+
+    int getNumStoredLumens() const; // lumens in the prefix and the sparse map
+    Nova toNova(ILuminosity* luminate) const; // every lumen stored, as a dynamic Nova
+
+private:
+    int initialBrightness;
+    int initialSize;
+    int initialPower;
+    int numLumens;
+    bool untouchedCharged; // a recharge round has run, and it recharges every untouched lumen
+
+    LumenBank prefix; // lumens [0, prefix.size())
+    std::map<int, LumenCell> touched; // stored lumens at or past the prefix, by index
+    int touchedErratic; // states of the lumens in touched
+    int touchedDimmed;
+
+    LumenCell untouchedLumen(int index) const;
+    unsigned long long untouchedValue(int index) const; // glow value before wrapping to an int
+    int firstIndexReaching(int begin, int end, unsigned long long value) const;
+    void untouchedRange(int& low, int& high, bool& found) const;
+    void extendPrefix(int end);
+    LumenCell& touchLumen(int index);
+    void countTouched(const LumenCell& lumen, int delta);
+    void rechargeInactiveLumens();
+};
+
+#endif // LAZY_NOVA_H
+
+
+/*
+Class invariants for LazyNova:
+
+- 0 <= prefix.size() <= numLumens, and every key of touched is in [prefix.size(), numLumens).
+- Lumen i is stored in exactly one place: the prefix, touched, or nowhere; a lumen stored
+  nowhere is in the state Nova's constructor gives it, recharged if untouchedCharged.
+- touchedErratic and touchedDimmed count the erratic and dimmed lumens in touched.
+- brightness + numLumens - 1, size + numLumens - 1 and power + 10 * (numLumens - 1) fit in an int.
+*/
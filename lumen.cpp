@@ -29,6 +29,7 @@ When adding a lumen to another lumen, specific variables will be added. The same
 // - a lumen may be reset at most some number of times (dependent on size)
 
 #include "lumen.h"
+#include "nova_metrics.h"
 
 // Preconditions: inputBrightness, inputSize, and inputPower are positive
 // Postconditions: Lumen object is created with given input values
@@ -68,15 +69,19 @@ int Lumen::glow() {
 // Postconditions: Resets the Lumen object if conditions are met, otherwise reduces brightness by 1
 bool Lumen::reset() {
     if (resetCount >= maxReset){
+        NovaMetrics::add(NovaCounter::ResetFailures);
+        NovaMetrics::add(NovaCounter::ResetsExhausted);
         return false;
     }
 
     if (resetRequest()) {
         resetOriginal();
+        NovaMetrics::add(NovaCounter::ResetSuccesses);
         return true;
     }
 
     brightness--;
+    NovaMetrics::add(NovaCounter::ResetFailures);
     return false;
 }
 
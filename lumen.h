@@ -72,6 +72,11 @@ public:
     int getSize(); // For Nova to access these elements
     
 private:
+    friend class LumenBank; // the columnar store imports and materializes Lumen state
+    friend class PackedLumen; // the compact encoding packs and promotes Lumen state
+    friend class NovaSnapshot; // snapshots save and restore every field
+    friend class LumenCell; // fixed-size Novas hold lumens by value
+
     int brightness;
     int size;
     int power;
@@ -0,0 +1,1042 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The LumenBank class stores the lumens of a Nova column by column. All columns live in one
+64-byte aligned block, and every column starts on its own cache line, so a pass that only needs
+power and powerThreshold streams through exactly those two arrays.
+
+ASSUMPTIONS:
+- Lumens are appended to the bank from fully constructed Lumen objects, so every element
+  starts out obeying the Lumen class invariants.
+- Indices passed to the per-element operations are in range [0, size()).
+- The per-element operations mirror Lumen::glow, Lumen::reset, Lumen::recharge, ... exactly,
+  so a Nova backed by a bank behaves like one backed by individual Lumen objects.
+*/
+
+#include "lumen_bank.h"
+#include "nova_metrics.h"
+#include "work_stealing_pool.h"
+#include <new>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <climits>
+
+namespace {
+constexpr int COLUMNALIGN = 64;
+constexpr int INTSPERLINE = COLUMNALIGN / sizeof(int);
+constexpr int MINCHUNK = 8192; // smallest share of a parallel pass worth a task
+constexpr int STATSBLOCK = 1024; // glow values computed at a time by addGlowStats, fits in L1
+
+// Pre-Condition: n is non-negative
+// Post-Condition: returns n rounded up so each int column fills whole cache lines
+int roundCapacity(int n) {
+    return (n + INTSPERLINE - 1) / INTSPERLINE * INTSPERLINE;
+}
+
+// Pre-Condition: begin <= end; numThreads is positive
+// Post-Condition: returns the boundaries of the chunks [begin, end) is split into for numThreads
+//                 threads; chunks hold at least MINCHUNK lumens and inner boundaries fall on
+//                 cache line boundaries of the columns, so no two tasks write the same line
+std::vector<int> chunkBounds(int begin, int end, int numThreads) {
+    int length = end - begin;
+    int numChunks = std::max(1, std::min(numThreads * 4, length / MINCHUNK));
+    std::vector<int> bounds{begin};
+    for (int c = 1; c < numChunks; c++) {
+        int bound = static_cast<int>(begin + static_cast<long long>(length) * c / numChunks);
+        bound = bound / INTSPERLINE * INTSPERLINE;
+        if (bound > bounds.back()) {
+            bounds.push_back(bound);
+        }
+    }
+    bounds.push_back(end);
+    return bounds;
+}
+
+// Pre-Condition: from != to
+// Post-Condition: the transition is counted in NovaMetrics
+void countTransition(LumenState from, LumenState to) {
+    if (to == LumenState::Active) {
+        NovaMetrics::add(NovaCounter::Reactivated);
+    } else if (from == LumenState::Active) {
+        NovaMetrics::add(to == LumenState::Erratic ? NovaCounter::ActiveToErratic : NovaCounter::ActiveToDimmed);
+    } else if (to == LumenState::Dimmed) {
+        NovaMetrics::add(NovaCounter::ErraticToDimmed);
+    }
+}
+}
+
+/************************************** LumenRef *************************************************/
+
+// Pre-Condition: bank is a valid LumenBank and index is in range
+// Post-Condition: handle refers to element index of bank
+LumenRef::LumenRef(LumenBank* bank, int index) : bank(bank), index(index) {}
+
+// Pre-Condition: None
+// Post-Condition: Returns the glow value based on the state of the referenced lumen
+int LumenRef::glow() {
+    return bank->glow(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Resets the referenced lumen if conditions are met, otherwise reduces brightness by 1
+bool LumenRef::reset() {
+    return bank->reset(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: power restored to its original value and charged set to true
+void LumenRef::recharge() {
+    bank->recharge(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the referenced lumen is active, otherwise false
+bool LumenRef::isActive() const {
+    return bank->isActive(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the referenced lumen is erratic, otherwise false
+bool LumenRef::isErratic() const {
+    return bank->isErratic(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the current glow value of the referenced lumen
+int LumenRef::currentGlowValue() const {
+    return bank->currentGlowValue(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the brightness of the referenced lumen
+int LumenRef::getBrightness() const {
+    return bank->getBrightness(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the power of the referenced lumen
+int LumenRef::getPower() const {
+    return bank->getPower(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the size of the referenced lumen
+int LumenRef::getSize() const {
+    return bank->getSize(index);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns a standalone Lumen with the same state as the referenced lumen
+Lumen LumenRef::toLumen() const {
+    return bank->lumenAt(index);
+}
+
+/************************************* LumenBank Constructors *************************************/
+
+// Pre-Condition: None
+// Post-Condition: an empty bank with no storage is created
+LumenBank::LumenBank()
+: count(0), cap(0), block(nullptr),
+  brightness(nullptr), sizes(nullptr), power(nullptr), brightnessCopy(nullptr), powerCopy(nullptr),
+  dimmingValue(nullptr), powerThreshold(nullptr), glowRequest(nullptr), maxReset(nullptr),
+  resetCount(nullptr), charged(nullptr), dirtyBegin(0), dirtyEnd(0) {}
+
+// Pre-Condition: None
+// Post-Condition: Frees the column block
+LumenBank::~LumenBank() {
+    releaseBlock();
+}
+
+// Pre-Condition: other must be a valid LumenBank
+// Post-Condition: Creates a deep copy of other's columns
+LumenBank::LumenBank(const LumenBank& other) : LumenBank() {
+    allocate(other.count);
+    copyColumns(other, other.count);
+    count = other.count;
+    copyTracking(other);
+}
+
+// Pre-Condition: other must be a valid LumenBank
+// Post-Condition: Takes ownership of other's block; other is left empty
+LumenBank::LumenBank(LumenBank&& other) noexcept : LumenBank() {
+    *this = std::move(other);
+}
+
+// Pre-Condition: other must be a valid LumenBank
+// Post-Condition: this bank holds a deep copy of other's lumens
+LumenBank& LumenBank::operator=(const LumenBank& other) {
+    if (this != &other) {
+        if (cap < other.count) {
+            releaseBlock();
+            allocate(other.count);
+        }
+        copyColumns(other, other.count);
+        count = other.count;
+        copyTracking(other);
+    }
+    return *this;
+}
+
+// Pre-Condition: other must be a valid LumenBank
+// Post-Condition: this bank takes ownership of other's block (or copies other's inline columns);
+//                 other is left empty
+LumenBank& LumenBank::operator=(LumenBank&& other) noexcept {
+    if (this != &other && other.block == other.inlineBlock) {
+        releaseBlock();
+        allocate(other.cap); // inline, so it cannot throw
+        copyColumns(other, other.count);
+        count = other.count;
+        moveTracking(other);
+        other.releaseBlock();
+        other.resetTracking();
+    } else if (this != &other) {
+        releaseBlock();
+        count = other.count;
+        cap = other.cap;
+        block = other.block;
+        brightness = other.brightness;
+        sizes = other.sizes;
+        power = other.power;
+        brightnessCopy = other.brightnessCopy;
+        powerCopy = other.powerCopy;
+        dimmingValue = other.dimmingValue;
+        powerThreshold = other.powerThreshold;
+        glowRequest = other.glowRequest;
+        maxReset = other.maxReset;
+        resetCount = other.resetCount;
+        charged = other.charged;
+        moveTracking(other);
+
+        other.count = 0;
+        other.cap = 0;
+        other.block = nullptr;
+        other.brightness = other.sizes = other.power = nullptr;
+        other.brightnessCopy = other.powerCopy = nullptr;
+        other.dimmingValue = other.powerThreshold = nullptr;
+        other.glowRequest = other.maxReset = other.resetCount = nullptr;
+        other.charged = nullptr;
+        other.resetTracking();
+    }
+    return *this;
+}
+
+/************************************* Storage Management *****************************************/
+
+// Pre-Condition: None
+// Post-Condition: returns the number of lumens in the bank
+int LumenBank::size() const {
+    return count;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of lumens the bank can hold without reallocating
+int LumenBank::capacity() const {
+    return cap;
+}
+
+// Pre-Condition: newCapacity is non-negative
+// Post-Condition: capacity() >= newCapacity and the stored lumens are unchanged
+void LumenBank::reserve(int newCapacity) {
+    if (newCapacity <= cap) {
+        return;
+    }
+    if (newCapacity <= INLINELUMENS) {
+        allocate(newCapacity); // no block yet (an inline bank has cap INLINELUMENS), and this cannot throw
+        return;
+    }
+    LumenBank grown;
+    grown.allocate(newCapacity);
+    grown.copyColumns(*this, count);
+    grown.count = count;
+    grown.moveTracking(*this);
+    *this = std::move(grown);
+}
+
+// Pre-Condition: extra is non-negative
+// Post-Condition: extra more lumens can be appended without reallocating; capacity grows at
+//                 least geometrically so a series of appends costs amortized O(1) per lumen
+void LumenBank::growFor(int extra) {
+    if (count + extra > cap) {
+        reserve(std::max(count + extra, cap * 2));
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: capacity() is as small as the column layout allows for size() lumens
+void LumenBank::shrinkToFit() {
+    if (roundCapacity(count) == cap) {
+        return;
+    }
+    if (count == 0) {
+        releaseBlock();
+        resetTracking();
+        return;
+    }
+    LumenBank shrunk;
+    shrunk.allocate(count);
+    shrunk.copyColumns(*this, count);
+    shrunk.count = count;
+    shrunk.moveTracking(*this);
+    *this = std::move(shrunk);
+}
+
+// Pre-Condition: lumen obeys the Lumen class invariants
+// Post-Condition: a copy of lumen's state is stored as the new last element
+void LumenBank::append(const Lumen& lumen) {
+    growFor(1);
+    count++;
+    writeLumen(count - 1, lumen);
+    glowOrder.add(currentGlowValue(count - 1));
+    stateIndex.add(stateAt(count - 1, power[count - 1]));
+    markDirty(count - 1);
+}
+
+// Pre-Condition: other must be a valid LumenBank; it may be this bank
+// Post-Condition: copies of other's lumens are stored as the new last elements, in order; every
+//                 column is copied in one block and only other's dirty range is marked dirty
+void LumenBank::append(const LumenBank& other) {
+    int n = other.count;
+    if (n == 0) {
+        return;
+    }
+    int first = count;
+    int otherDirtyBegin = other.dirtyBegin;
+    int otherDirtyEnd = other.dirtyEnd;
+    growFor(n); // other's columns are read after the growth, in case other is this bank
+    copyColumns(other, n, first);
+    if (first == 0) {
+        count = n;
+        copyTracking(other);
+        return;
+    }
+    count += n;
+    trackAppended(first);
+    markDirty(first + otherDirtyBegin, first + otherDirtyEnd);
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: element index holds a copy of lumen's state
+void LumenBank::assign(int index, const Lumen& lumen) {
+    LumenState oldState = stateAt(index, power[index]);
+    int oldValue = currentGlowValue(index);
+    writeLumen(index, lumen);
+    track(index, oldState, oldValue);
+    markDirty(index);
+}
+
+// Pre-Condition: 0 <= index < cap
+// Post-Condition: every column of element index holds lumen's state; the glow order is not touched
+void LumenBank::writeLumen(int index, const Lumen& lumen) {
+    brightness[index] = lumen.brightness;
+    sizes[index] = lumen.size;
+    power[index] = lumen.power;
+    brightnessCopy[index] = lumen.brightnessCopy;
+    powerCopy[index] = lumen.powerCopy;
+    dimmingValue[index] = lumen.dimmingValue;
+    powerThreshold[index] = lumen.powerThreshold;
+    glowRequest[index] = lumen.glowRequest;
+    maxReset[index] = lumen.maxReset;
+    resetCount[index] = lumen.resetCount;
+    charged[index] = lumen.charged;
+}
+
+// Pre-Condition: the bank holds at least one lumen
+// Post-Condition: the last lumen is dropped
+void LumenBank::removeLast() {
+    if (count <= 0) {
+        throw std::runtime_error("Cannot remove a lumen from an empty LumenBank.");
+    }
+    glowOrder.removeLast();
+    stateIndex.removeLast();
+    count--;
+}
+
+// Pre-Condition: 0 <= n <= size()
+// Post-Condition: the last n lumens are removed; the storage is kept for reuse
+void LumenBank::removeLast(int n) {
+    if (n < 0 || n > count) {
+        throw std::runtime_error("Cannot remove more lumens than the LumenBank holds.");
+    }
+    if (n == count) {
+        resetTracking();
+    } else {
+        for (int i = count - 1; i >= count - n; i--) {
+            glowOrder.removeLast();
+            stateIndex.removeLast();
+        }
+    }
+    count -= n;
+}
+
+// Pre-Condition: None
+// Post-Condition: the bank holds no lumens and its storage is released
+void LumenBank::clear() {
+    releaseBlock();
+    resetTracking();
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns a standalone Lumen with the state of element index
+Lumen LumenBank::lumenAt(int index) const {
+    Lumen lumen(1, 1, 1);
+    lumen.brightness = brightness[index];
+    lumen.size = sizes[index];
+    lumen.power = power[index];
+    lumen.brightnessCopy = brightnessCopy[index];
+    lumen.powerCopy = powerCopy[index];
+    lumen.dimmingValue = dimmingValue[index];
+    lumen.powerThreshold = powerThreshold[index];
+    lumen.glowRequest = glowRequest[index];
+    lumen.maxReset = maxReset[index];
+    lumen.resetCount = resetCount[index];
+    lumen.charged = charged[index];
+    return lumen;
+}
+
+// Pre-Condition: index and otherIndex are in range of their banks
+// Post-Condition: returns true if both elements have the same brightness, power, and size
+bool LumenBank::sameValues(int index, const LumenBank& other, int otherIndex) const {
+    return brightness[index] == other.brightness[otherIndex] &&
+           power[index] == other.power[otherIndex] &&
+           sizes[index] == other.sizes[otherIndex];
+}
+
+/************************************* Per-Element Operations *************************************/
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns the glow value based on the state of the element, like Lumen::glow
+int LumenBank::glow(int index) {
+    LumenState oldState = stateAt(index, power[index]);
+    int oldValue = currentGlowValue(index);
+    NovaMetrics::add(NovaCounter::LumenGlows);
+    glowRequest[index]++;
+    power[index]--;
+    track(index, oldState, oldValue);
+    markDirty(index);
+    return currentGlowValue(index);
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Resets the element if conditions are met, otherwise reduces brightness by 1
+bool LumenBank::reset(int index) {
+    if (resetCount[index] >= maxReset[index]) {
+        NovaMetrics::add(NovaCounter::ResetFailures);
+        NovaMetrics::add(NovaCounter::ResetsExhausted);
+        return false;
+    }
+
+    LumenState oldState = stateAt(index, power[index]);
+    int oldValue = currentGlowValue(index);
+    bool wasReset = glowRequest[index] >= RESETTHRESHOLD && power[index] > INACTIVESTATE;
+    if (wasReset) {
+        power[index] = powerCopy[index];
+        brightness[index] = brightnessCopy[index];
+        glowRequest[index] = 0;
+        resetCount[index]++;
+    } else {
+        brightness[index]--;
+    }
+    NovaMetrics::add(wasReset ? NovaCounter::ResetSuccesses : NovaCounter::ResetFailures);
+    track(index, oldState, oldValue);
+    markDirty(index);
+    return wasReset;
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: power restored to its original value and charged set to true
+void LumenBank::recharge(int index) {
+    LumenState oldState = stateAt(index, power[index]);
+    int oldValue = currentGlowValue(index);
+    power[index] = powerCopy[index];
+    charged[index] = true;
+    track(index, oldState, oldValue);
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns true if the element is active, otherwise false
+bool LumenBank::isActive(int index) const {
+    return power[index] > powerThreshold[index];
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns true if the element is erratic, otherwise false
+bool LumenBank::isErratic(int index) const {
+    return power[index] <= powerThreshold[index] && power[index] > INACTIVESTATE;
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: return brightness * size if the element is active, otherwise dimmingValue or its erratic value
+int LumenBank::currentGlowValue(int index) const {
+    return glowValueAt(index, power[index]);
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns the brightness of the element
+int LumenBank::getBrightness(int index) const {
+    return brightness[index];
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns the power of the element
+int LumenBank::getPower(int index) const {
+    return power[index];
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns the size of the element
+int LumenBank::getSize(int index) const {
+    return sizes[index];
+}
+
+/************************************* Batch Operations *******************************************/
+
+// Pre-Condition: 0 <= begin <= end <= size(); glowValues holds end - begin ints
+// Post-Condition: glowValues receives the current glow value of lumens [begin, end)
+void LumenBank::currentGlowValues(int begin, int end, int* glowValues) const {
+    glowKernels().currentGlowValues(columns(), begin, end, glowValues);
+}
+
+// Pre-Condition: 0 <= begin <= end <= size(); states holds end - begin entries
+// Post-Condition: states receives whether each lumen in [begin, end) is active, erratic or dimmed
+void LumenBank::classify(int begin, int end, LumenState* states) const {
+    glowKernels().classify(columns(), begin, end, states);
+}
+
+/************************************* Whole-Bank Passes ******************************************/
+
+// Pre-Condition: 0 <= x <= size()
+// Post-Condition: the first x lumens have glowed once
+void LumenBank::glowFirst(int x) {
+    NovaMetrics::add(NovaCounter::LumenGlows, x);
+    glowTracked(0, x);
+}
+
+// Pre-Condition: 0 <= x <= size(); no other thread uses the bank
+// Post-Condition: the first x lumens have glowed once, exactly as glowFirst(x) leaves them
+void LumenBank::glowFirst(int x, WorkStealingPool& pool) {
+    std::vector<int> bounds = chunkBounds(0, x, pool.getNumThreads());
+    int numChunks = static_cast<int>(bounds.size()) - 1;
+    if (numChunks <= 1) {
+        glowFirst(x);
+        return;
+    }
+    NovaMetrics::add(NovaCounter::LumenGlows, x);
+    if (static_cast<int>(changed.size()) < x) {
+        changed.resize(x);
+    }
+
+    // Every chunk glows its lumens and collects the changed ones into its own slice of changed
+    std::vector<int> found(numChunks);
+    LumenColumns cols = columns();
+    pool.parallelFor(numChunks, [&](int c) {
+        found[c] = glowKernels().glowAndCollect(cols, bounds[c], bounds[c + 1], changed.data() + bounds[c]);
+    });
+
+    // parallelFor has joined every task; the glow and state indexes are updated on this thread
+    for (int c = 0; c < numChunks; c++) {
+        for (int k = 0; k < found[c]; k++) {
+            int i = changed[bounds[c] + k];
+            track(i, stateAt(i, power[i] + 1), glowValueAt(i, power[i] + 1));
+        }
+    }
+    markDirty(0, x);
+}
+
+// Pre-Condition: 0 <= x <= size(); ticks is non-negative
+// Post-Condition: the first x lumens have glowed ticks times, exactly as ticks calls of glowFirst(x)
+void LumenBank::glowFirst(int x, int ticks) {
+    NovaMetrics::add(NovaCounter::LumenGlows, static_cast<std::uint64_t>(x) * ticks);
+    for (int i = 0; i < x; i++) {
+        LumenState oldState = stateAt(i, power[i]);
+        int oldValue = currentGlowValue(i);
+        power[i] -= ticks;
+        glowRequest[i] += ticks;
+        track(i, oldState, oldValue);
+    }
+    markDirty(0, x);
+}
+
+// Pre-Condition: 0 <= x <= size(); ticks is non-negative
+// Post-Condition: the bank is in the state ticks rounds of glowFirst(x) followed by rechargeActive()
+//                 would leave it in
+void LumenBank::glowFirstAndRecharge(int x, int ticks) {
+    if (ticks == 0) {
+        return;
+    }
+    NovaMetrics::add(NovaCounter::LumenGlows, static_cast<std::uint64_t>(x) * ticks);
+    for (int i = 0; i < count; i++) {
+        LumenState oldState = stateAt(i, power[i]);
+        int oldValue = currentGlowValue(i);
+        if (i >= x) {
+            // A lumen that does not glow is only touched by the first recharge
+            if (power[i] > powerThreshold[i]) {
+                power[i] = powerCopy[i];
+                charged[i] = true;
+            }
+        } else {
+            glowRequest[i] += ticks;
+            int remaining = ticks;
+            while (remaining > 0) {
+                if (power[i] <= powerThreshold[i]) {
+                    // inactive lumens are never recharged again, they just keep dimming
+                    power[i] -= remaining;
+                    break;
+                }
+                power[i]--;
+                remaining--;
+                if (power[i] > powerThreshold[i]) {
+                    power[i] = powerCopy[i];
+                    charged[i] = true;
+                    if (powerCopy[i] - 1 > powerThreshold[i]) {
+                        break; // every further round glows it to powerCopy - 1 and recharges it back
+                    }
+                }
+            }
+        }
+        track(i, oldState, oldValue);
+    }
+    dirtyBegin = dirtyEnd = 0; // every active lumen now sits at powerCopy and is charged
+}
+
+// Pre-Condition: 0 <= x <= size()
+// Post-Condition: returns the smallest t >= 1 such that after t calls of glowFirst(x) at least
+//                 wanted lumens are inactive, or -1 if that never happens
+int LumenBank::ticksUntilInactive(int x, int wanted) const {
+    // lumen i (i < x) is inactive after t glows once t >= power - powerThreshold
+    std::vector<long long> inactiveAfter(x);
+    int inactiveGlowing = 0;
+    for (int i = 0; i < x; i++) {
+        inactiveAfter[i] = static_cast<long long>(power[i]) - powerThreshold[i];
+        if (inactiveAfter[i] <= 0) {
+            inactiveGlowing++;
+        }
+    }
+
+    // lumens that do not glow never change state
+    int needed = wanted - (countInactive() - inactiveGlowing);
+    if (needed <= 0) {
+        return 1;
+    }
+    if (needed > x) {
+        return -1;
+    }
+    std::nth_element(inactiveAfter.begin(), inactiveAfter.begin() + (needed - 1), inactiveAfter.end());
+    long long ticks = std::max(1LL, inactiveAfter[needed - 1]);
+    return ticks > INT_MAX ? -1 : static_cast<int>(ticks);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of lumens that are not active
+int LumenBank::countInactive() const {
+    return stateIndex.count(LumenState::Erratic) + stateIndex.count(LumenState::Dimmed);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of active lumens
+int LumenBank::countActive() const {
+    return stateIndex.count(LumenState::Active);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of erratic lumens
+int LumenBank::countErratic() const {
+    return stateIndex.count(LumenState::Erratic);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the ids of the lumens in state, in no particular order
+LumenIdRange LumenBank::lumensIn(LumenState state) const {
+    return stateIndex.ids(state);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the ids of the lumens that are not active, in no particular order
+LumenIdRange LumenBank::inactiveLumens() const {
+    return stateIndex.inactiveIds();
+}
+
+// Pre-Condition: None
+// Post-Condition: every active (and therefore not erratic) lumen has been recharged
+void LumenBank::rechargeActive() {
+    // lumens outside the dirty range are either inactive or already at powerCopy and charged
+    int end = std::min(dirtyEnd, count);
+    if (countActive() < (end - dirtyBegin) / ACTIVEWALKRATIO) {
+        rechargeActiveBucket();
+        return;
+    }
+    for (int i = dirtyBegin; i < end; i++) {
+        if (power[i] > powerThreshold[i]) {
+            int oldValue = glowValueAt(i, power[i]);
+            power[i] = powerCopy[i];
+            charged[i] = true;
+            // only lumens built with Lumen arithmetic can turn inactive here
+            track(i, LumenState::Active, oldValue);
+        }
+    }
+    dirtyBegin = dirtyEnd = 0;
+}
+
+// Pre-Condition: None
+// Post-Condition: every active lumen has been recharged, exactly as rechargeActive() leaves them
+void LumenBank::rechargeActiveBucket() {
+    // walked from the back: a lumen that turns inactive only swaps with an already visited one
+    LumenIdRange active = lumensIn(LumenState::Active);
+    for (const int* id = active.end(); id != active.begin();) {
+        int i = *--id;
+        int oldValue = glowValueAt(i, power[i]);
+        power[i] = powerCopy[i];
+        charged[i] = true;
+        track(i, LumenState::Active, oldValue);
+    }
+    dirtyBegin = dirtyEnd = 0;
+}
+
+// Pre-Condition: no other thread uses the bank
+// Post-Condition: every active lumen has been recharged, exactly as rechargeActive() leaves them
+void LumenBank::rechargeActive(WorkStealingPool& pool) {
+    int begin = dirtyBegin;
+    int end = std::min(dirtyEnd, count);
+    std::vector<int> bounds = chunkBounds(begin, std::max(begin, end), pool.getNumThreads());
+    int numChunks = static_cast<int>(bounds.size()) - 1;
+    if (numChunks <= 1) {
+        rechargeActive();
+        return;
+    }
+    if (static_cast<int>(changed.size()) < end) {
+        changed.resize(end);
+    }
+
+    // A recharged lumen that stays active keeps its glow value (brightness * size) and state,
+    // so the tasks only set it aside when recharging would change its state
+    std::vector<int> found(numChunks);
+    pool.parallelFor(numChunks, [&](int c) {
+        int n = 0;
+        for (int i = bounds[c]; i < bounds[c + 1]; i++) {
+            if (power[i] > powerThreshold[i]) {
+                if (powerCopy[i] > powerThreshold[i]) {
+                    power[i] = powerCopy[i];
+                    charged[i] = true;
+                } else {
+                    changed[bounds[c] + n++] = i;
+                }
+            }
+        }
+        found[c] = n;
+    });
+
+    // only lumens built with Lumen arithmetic can turn inactive here
+    for (int c = 0; c < numChunks; c++) {
+        for (int k = 0; k < found[c]; k++) {
+            int i = changed[bounds[c] + k];
+            int oldValue = glowValueAt(i, power[i]);
+            power[i] = powerCopy[i];
+            charged[i] = true;
+            track(i, LumenState::Active, oldValue);
+        }
+    }
+    dirtyBegin = dirtyEnd = 0;
+}
+
+// Pre-Condition: the bank holds at least one lumen
+// Post-Condition: returns the smallest current glow value in the bank
+int LumenBank::minGlowValue() const {
+    return glowOrder.minValue();
+}
+
+// Pre-Condition: the bank holds at least one lumen
+// Post-Condition: returns the largest current glow value in the bank
+int LumenBank::maxGlowValue() const {
+    return glowOrder.maxValue();
+}
+
+// Pre-Condition: k >= 0
+// Post-Condition: returns the min(k, size()) lumens with the largest glow values, largest first;
+//                 of lumens with equal values the lower index comes first
+std::vector<LumenGlow> LumenBank::brightest(int k) const {
+    return glowOrder.largest(k);
+}
+
+// Pre-Condition: k >= 0
+// Post-Condition: returns the min(k, size()) lumens with the smallest glow values, smallest first;
+//                 of lumens with equal values the lower index comes first
+std::vector<LumenGlow> LumenBank::dimmest(int k) const {
+    return glowOrder.smallest(k);
+}
+
+// Pre-Condition: None
+// Post-Condition: stats also counts the current glow value of every lumen in the bank
+void LumenBank::addGlowStats(GlowStats& stats) const {
+    // the SIMD kernel fills a block that is still in L1 when stats reads it back
+    int glowValues[STATSBLOCK];
+    for (int begin = 0; begin < count; begin += STATSBLOCK) {
+        int end = std::min(begin + STATSBLOCK, count);
+        currentGlowValues(begin, end, glowValues);
+        stats.add(glowValues, end - begin);
+    }
+}
+
+// Pre-Condition: 1 <= rank <= size()
+// Post-Condition: returns the rank-th smallest current glow value in the bank
+int LumenBank::glowValueAtRank(long long rank) const {
+    if (rank < 1 || rank > count) {
+        throw std::out_of_range("LumenBank holds fewer lumens than the rank.");
+    }
+    std::vector<int> values(count);
+    currentGlowValues(0, count, values.data());
+    std::vector<int>::iterator nth = values.begin() + (rank - 1);
+    std::nth_element(values.begin(), nth, values.end());
+    return *nth;
+}
+
+/************************************* Private Helpers ********************************************/
+
+// Pre-Condition: None
+// Post-Condition: returns the column pointers the batch kernels work on
+LumenColumns LumenBank::columns() const {
+    return LumenColumns{brightness, sizes, power, powerThreshold, dimmingValue, glowRequest};
+}
+
+// Pre-Condition: the bank holds no block; newCapacity is non-negative
+// Post-Condition: a block with room for at least newCapacity lumens is set up and the columns point
+//                 into it; up to INLINELUMENS lumens use inlineBlock and allocate nothing
+void LumenBank::allocate(int newCapacity) {
+    static_assert(INLINEALIGN == COLUMNALIGN && INLINELUMENS % INTSPERLINE == 0 && INLINELUMENS <= COLUMNALIGN,
+                  "inlineBlock must have the layout of a heap block of INLINELUMENS lumens");
+    cap = roundCapacity(newCapacity);
+    count = 0;
+    if (cap == 0) {
+        return;
+    }
+    if (cap <= INLINELUMENS) {
+        cap = INLINELUMENS;
+    }
+    size_t intColumnBytes = static_cast<size_t>(cap) * sizeof(int);
+    size_t boolColumnBytes = (static_cast<size_t>(cap) * sizeof(bool) + COLUMNALIGN - 1) / COLUMNALIGN * COLUMNALIGN;
+    if (cap == INLINELUMENS) {
+        block = inlineBlock;
+    } else {
+        block = static_cast<char*>(::operator new(intColumnBytes * NUMINTCOLUMNS + boolColumnBytes,
+                                                  std::align_val_t(COLUMNALIGN)));
+    }
+
+    int** columns[NUMINTCOLUMNS] = {&brightness, &sizes, &power, &brightnessCopy, &powerCopy,
+                                    &dimmingValue, &powerThreshold, &glowRequest, &maxReset, &resetCount};
+    for (int c = 0; c < NUMINTCOLUMNS; c++) {
+        *columns[c] = reinterpret_cast<int*>(block + intColumnBytes * c);
+    }
+    charged = reinterpret_cast<bool*>(block + intColumnBytes * NUMINTCOLUMNS);
+}
+
+// Pre-Condition: cap >= first + n and other holds at least n lumens
+// Post-Condition: elements [first, first + n) of every column are copied from other's first n
+void LumenBank::copyColumns(const LumenBank& other, int n, int first) {
+    if (n == 0) {
+        return;
+    }
+    size_t bytes = static_cast<size_t>(n) * sizeof(int);
+    std::memcpy(brightness + first, other.brightness, bytes);
+    std::memcpy(sizes + first, other.sizes, bytes);
+    std::memcpy(power + first, other.power, bytes);
+    std::memcpy(brightnessCopy + first, other.brightnessCopy, bytes);
+    std::memcpy(powerCopy + first, other.powerCopy, bytes);
+    std::memcpy(dimmingValue + first, other.dimmingValue, bytes);
+    std::memcpy(powerThreshold + first, other.powerThreshold, bytes);
+    std::memcpy(glowRequest + first, other.glowRequest, bytes);
+    std::memcpy(maxReset + first, other.maxReset, bytes);
+    std::memcpy(resetCount + first, other.resetCount, bytes);
+    std::memcpy(charged + first, other.charged, static_cast<size_t>(n) * sizeof(bool));
+}
+
+// Pre-Condition: None
+// Post-Condition: the block is freed and the bank is empty with no capacity
+void LumenBank::releaseBlock() {
+    if (block && block != inlineBlock) {
+        ::operator delete(block, std::align_val_t(COLUMNALIGN));
+    }
+    block = nullptr;
+    count = 0;
+    cap = 0;
+    brightness = sizes = power = nullptr;
+    brightnessCopy = powerCopy = nullptr;
+    dimmingValue = powerThreshold = nullptr;
+    glowRequest = maxReset = resetCount = nullptr;
+    charged = nullptr;
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns the glow value element index would have if its power were p
+int LumenBank::glowValueAt(int index, int p) const {
+    unsigned litValue = static_cast<unsigned>(brightness[index]) * static_cast<unsigned>(sizes[index]);
+    if (p > powerThreshold[index]) {
+        return static_cast<int>(litValue);
+    }
+    if (p > INACTIVESTATE) {
+        int erraticFactor = 10;
+        return static_cast<int>(litValue * static_cast<unsigned>(p + erraticFactor));
+    }
+    return dimmingValue[index];
+}
+
+// Pre-Condition: 0 <= begin <= end <= size()
+// Post-Condition: lumens [begin, end) glowed once and the glow order follows every changed value
+void LumenBank::glowTracked(int begin, int end) {
+    if (static_cast<int>(changed.size()) < end - begin) {
+        changed.resize(end - begin);
+    }
+    int found = glowKernels().glowAndCollect(columns(), begin, end, changed.data());
+    for (int k = 0; k < found; k++) {
+        int i = changed[k];
+        track(i, stateAt(i, power[i] + 1), glowValueAt(i, power[i] + 1));
+    }
+    markDirty(begin, end);
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: returns the state element index would be in if its power were p
+LumenState LumenBank::stateAt(int index, int p) const {
+    if (p > powerThreshold[index]) {
+        return LumenState::Active;
+    }
+    return p > INACTIVESTATE ? LumenState::Erratic : LumenState::Dimmed;
+}
+
+// Pre-Condition: element index was in oldState with glow value oldValue before its last change
+// Post-Condition: the glow order and the state counters reflect the element's current state
+void LumenBank::track(int index, LumenState oldState, int oldValue) {
+    LumenState newState = stateAt(index, power[index]);
+    if (newState != oldState) {
+        stateIndex.move(index, newState);
+        countTransition(oldState, newState);
+    }
+    int newValue = currentGlowValue(index);
+    if (newValue != oldValue) {
+        glowOrder.update(index, newValue);
+    }
+}
+
+// Pre-Condition: 0 <= begin <= end <= size()
+// Post-Condition: elements [begin, end) are visited by the next rechargeActive()
+void LumenBank::markDirty(int begin, int end) {
+    if (begin >= end) {
+        return;
+    }
+    if (dirtyBegin == dirtyEnd) {
+        dirtyBegin = begin;
+        dirtyEnd = end;
+    } else {
+        dirtyBegin = std::min(dirtyBegin, begin);
+        dirtyEnd = std::max(dirtyEnd, end);
+    }
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: element index is visited by the next rechargeActive()
+void LumenBank::markDirty(int index) {
+    markDirty(index, index + 1);
+}
+
+// Pre-Condition: other holds the same elements as this bank
+// Post-Condition: this bank has other's glow order, state index and dirty range
+void LumenBank::copyTracking(const LumenBank& other) {
+    glowOrder = other.glowOrder;
+    stateIndex = other.stateIndex;
+    dirtyBegin = other.dirtyBegin;
+    dirtyEnd = other.dirtyEnd;
+}
+
+// Pre-Condition: other holds the same elements as this bank
+// Post-Condition: this bank has other's glow order, state index and dirty range; other's
+//                 indexes are left in a valid but unspecified state
+void LumenBank::moveTracking(LumenBank& other) {
+    glowOrder = std::move(other.glowOrder);
+    stateIndex = std::move(other.stateIndex);
+    dirtyBegin = other.dirtyBegin;
+    dirtyEnd = other.dirtyEnd;
+}
+
+// Pre-Condition: the bank holds no lumens
+// Post-Condition: the glow order, the state index and the dirty range are empty
+void LumenBank::resetTracking() {
+    glowOrder.clear();
+    stateIndex.clear();
+    dirtyBegin = dirtyEnd = 0;
+}
+
+// Pre-Condition: the columns of elements [0, size()) were written directly
+// Post-Condition: the glow order and state index describe those elements, and all of them
+//                 are visited by the next rechargeActive()
+void LumenBank::rebuildTracking() {
+    resetTracking();
+    // an inline bank needs no scratch allocation either
+    int smallValues[INLINELUMENS];
+    LumenState smallStates[INLINELUMENS];
+    std::vector<int> values;
+    std::vector<LumenState> states;
+    if (count > INLINELUMENS) {
+        values.resize(count);
+        states.resize(count);
+    }
+    int* valueData = count > INLINELUMENS ? values.data() : smallValues;
+    LumenState* stateData = count > INLINELUMENS ? states.data() : smallStates;
+    currentGlowValues(0, count, valueData);
+    classify(0, count, stateData);
+    stateIndex.assign(stateData, count);
+    glowOrder.assign(valueData, count);
+    markDirty(0, count);
+}
+
+// Pre-Condition: the columns of elements [first, size()) were written directly; the tracking
+//                state describes elements [0, first)
+// Post-Condition: the glow order and state index describe every element; the dirty range is
+//                 left to the caller
+void LumenBank::trackAppended(int first) {
+    int n = count - first;
+    int smallValues[INLINELUMENS];
+    std::vector<int> values;
+    if (n > INLINELUMENS) {
+        values.resize(n);
+    }
+    int* valueData = n > INLINELUMENS ? values.data() : smallValues;
+    currentGlowValues(first, count, valueData);
+    glowOrder.add(valueData, n);
+    for (int index = first; index < count; index++) {
+        stateIndex.add(stateAt(index, power[index]));
+    }
+}
+
+
+/*
+Implementation Invariant:
+- allocate() is only called on a bank without a block; reserve() builds the larger bank
+  separately and moves it in, so a failed allocation leaves the original bank untouched.
+- inlineBlock is laid out exactly like a heap block of INLINELUMENS lumens, so the kernels never
+  see the difference. Its columns cannot change owner, so moving an inline bank copies them;
+  that is at most INLINEBYTES bytes. stateIndex, glowOrder and changed keep up to INLINELUMENS
+  ids inline the same way, so a bank that never grows past INLINELUMENS never allocates.
+- glowFirst(), rechargeActive() and addGlowStats() apply the same rules as Lumen::glow(),
+  Lumen::recharge() and Lumen::currentGlowValue() but walk the columns directly instead of
+  dispatching per element; all but rechargeActive() go through the batch kernels of glow_kernels.h.
+- rechargeActive() only needs isActive(): an active lumen can never be erratic.
+- glowFirst(x, ticks) and glowFirstAndRecharge() jump over whole runs of ticks: without a recharge
+  power and glowRequest just move by ticks; with a recharge after every tick a glowing lumen
+  either settles at powerCopy after its first round or turns inactive and never recovers.
+- glowOrder and stateIndex follow the current glow value and state of every element. Every
+  operation that changes power, brightness, or a whole element updates them through track(); a
+  glow only has to touch the lumens that were active or erratic before and are not active after,
+  since every other glow value and state is unchanged. A changed value costs O(log size()) in
+  glowOrder whichever way it moved, so minGlowValue() and maxGlowValue() never scan.
+- Only glows, resets, append() and assign() can leave an active lumen below powerCopy or
+  uncharged, and each marks what it touched dirty; rechargeActive() walks just that range, so
+  after glow(x) it costs O(x) rather than O(size()). When the active lumens are much fewer than
+  the dirty range it walks the active bucket of stateIndex instead; recharging an active lumen
+  outside the dirty range changes nothing.
+- glowValueAt() uses unsigned arithmetic so the erratic product wraps exactly like the kernels.
+- The parallel glowFirst() and rechargeActive() give every task a disjoint, cache-line aligned
+  range of lumens and its own slice of changed; the glow and state indexes are only touched by
+  the calling thread after the pool has joined, so the outcome does not depend on the number of threads.
+*/
@@ -0,0 +1,224 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+LumenBank.h is the header file for the LumenBank class, which is the columnar backing store
+for the lumens of a Nova. Instead of one heap allocated Lumen per element, the bank keeps one
+contiguous array per Lumen field (brightness, size, power, powerThreshold, ...), all carved out
+of a single allocation. Passes over the whole Nova (glow, recharge, statistics) then only touch
+the columns they need, while min/max and top-k queries read the glow order kept beside them.
+
+A bank of up to INLINELUMENS lumens keeps its columns in a buffer inside the bank object, and
+its state index, glow order and glow scratch list hold as many ids inline, so a small Nova
+allocates nothing beyond its shared block. Growing past that moves them to the heap.
+
+LumenRef is a thin handle (bank + index) that gives per-element access to a lumen stored in a
+bank with the same interface as a standalone Lumen.
+*/
+
+#ifndef LUMEN_BANK_H
+#define LUMEN_BANK_H
+
+#include "lumen.h"
+#include "glow_kernels.h"
+#include "glow_order.h"
+#include "glow_stats.h"
+#include "small_vector.h"
+#include "state_index.h"
+#include <vector>
+
+class LumenBank;
+class WorkStealingPool;
+
+class LumenRef {
+public:
+    LumenRef(LumenBank* bank, int index);
+
+    int glow();
+    bool reset();
+    void recharge();
+
+    bool isActive() const;
+    bool isErratic() const;
+
+    int currentGlowValue() const;
+
+    int getBrightness() const;
+    int getPower() const;
+    int getSize() const;
+
+    Lumen toLumen() const; // standalone copy of the referenced lumen
+
+private:
+    LumenBank* bank;
+    int index;
+};
+
+class LumenBank {
+public:
+    LumenBank();
+    ~LumenBank();
+    LumenBank(const LumenBank& other);
+    LumenBank(LumenBank&& other) noexcept;
+    LumenBank& operator=(const LumenBank& other);
+    LumenBank& operator=(LumenBank&& other) noexcept;
+
+    int size() const;
+    int capacity() const;
+
+    void reserve(int newCapacity); // exactly newCapacity (rounded to whole cache lines)
+    void growFor(int extra); // room for extra more lumens, growing geometrically
+    void shrinkToFit();
+    void append(const Lumen& lumen);
+    void append(const LumenBank& other); // every lumen of other (may be this bank), one copy per column
+    template <class Generator>
+    void appendGenerated(int count, Generator generator); // generator(i) returns the i-th new Lumen; one pass
+    void assign(int index, const Lumen& lumen);
+    void removeLast();
+    void removeLast(int n); // drops the last n lumens in one O(n) step
+    void clear();
+
+    Lumen lumenAt(int index) const;
+    bool sameValues(int index, const LumenBank& other, int otherIndex) const; // same rule as Lumen::operator==
+
+    // Per-element operations, same semantics as the Lumen members of the same name
+    int glow(int index);
+    bool reset(int index);
+    void recharge(int index);
+
+    bool isActive(int index) const;
+    bool isErratic(int index) const;
+    int currentGlowValue(int index) const;
+
+    int getBrightness(int index) const;
+    int getPower(int index) const;
+    int getSize(int index) const;
+
+    // Batch versions of currentGlowValue / isActive+isErratic over [begin, end),
+    // evaluated by the SIMD kernels selected for this CPU
+    void currentGlowValues(int begin, int end, int* glowValues) const;
+    void classify(int begin, int end, LumenState* states) const;
+
+    // Whole-bank passes used by Nova
+    void glowFirst(int x);
+    void glowFirst(int x, WorkStealingPool& pool); // glowFirst(x), split over the pool
+    void glowFirst(int x, int ticks); // ticks calls of glowFirst(x), in one pass
+    void glowFirstAndRecharge(int x, int ticks); // ticks rounds of glowFirst(x) + rechargeActive(), in one pass
+    int ticksUntilInactive(int x, int wanted) const; // glows of the first x lumens until wanted are inactive
+    int countInactive() const; // O(1), like countActive() and countErratic()
+    int countActive() const;
+    int countErratic() const;
+    LumenIdRange lumensIn(LumenState state) const; // ids of the lumens in state, valid until the next change
+    LumenIdRange inactiveLumens() const; // ids of the erratic and dimmed lumens
+    void rechargeActive(); // only visits lumens changed since the last recharge
+    void rechargeActive(WorkStealingPool& pool); // rechargeActive(), split over the pool
+    int minGlowValue() const; // O(1), the top of the glow order
+    int maxGlowValue() const; // O(1), the top of the glow order
+    std::vector<LumenGlow> brightest(int k) const; // O(k log k), largest glow value first, ties by index
+    std::vector<LumenGlow> dimmest(int k) const; // O(k log k), smallest glow value first, ties by index
+    void addGlowStats(GlowStats& stats) const; // adds every current glow value, in one pass
+    int glowValueAtRank(long long rank) const; // exact rank-th smallest glow value (1-based), O(n)
+
+private:
+    friend class NovaSnapshot; // snapshots read and write the columns in bulk
+    friend class FleetImage; // fleet images write the columns in bulk
+    friend class NovaScheduler; // keeps the power of glowing lumens lazily
+
+    int count;
+    int cap;
+    char* block; // single allocation holding every column, or inlineBlock for small banks
+
+    int* brightness;
+    int* sizes;
+    int* power;
+    int* brightnessCopy;
+    int* powerCopy;
+    int* dimmingValue;
+    int* powerThreshold;
+    int* glowRequest;
+    int* maxReset;
+    int* resetCount;
+    bool* charged;
+
+    GlowOrder glowOrder; // current glow value of every element, in order both ways
+    StateIndex stateIndex; // ids of the elements, grouped by LumenState
+    int dirtyBegin; // [dirtyBegin, dirtyEnd) holds every active element that may need a recharge
+    int dirtyEnd;
+
+    static constexpr int INACTIVESTATE = 0;
+    static constexpr int RESETTHRESHOLD = 5;
+    static constexpr int NUMINTCOLUMNS = 10;
+    static constexpr int ACTIVEWALKRATIO = 8; // recharge walks the active ids once they are this much rarer than the dirty range
+    static constexpr int INLINEALIGN = 64; // cache line, the alignment of every column
+    static constexpr int INLINELUMENS = 16; // lumens a bank holds in inlineBlock, one cache line per int column
+    static constexpr int INLINEBYTES = INLINELUMENS * static_cast<int>(sizeof(int)) * NUMINTCOLUMNS + INLINEALIGN;
+
+    alignas(INLINEALIGN) char inlineBlock[INLINEBYTES]; // the block of a bank of up to INLINELUMENS lumens
+    SmallVector<int, INLINELUMENS> changed; // scratch list of lumens changed by a batch glow
+
+    LumenColumns columns() const;
+    void allocate(int newCapacity);
+    void copyColumns(const LumenBank& other, int n, int first = 0);
+    void releaseBlock();
+    void writeLumen(int index, const Lumen& lumen);
+    int glowValueAt(int index, int p) const;
+    void glowTracked(int begin, int end);
+    LumenState stateAt(int index, int p) const;
+    void track(int index, LumenState oldState, int oldValue);
+    void rechargeActiveBucket();
+    void markDirty(int begin, int end);
+    void markDirty(int index);
+    void copyTracking(const LumenBank& other);
+    void moveTracking(LumenBank& other);
+    void resetTracking();
+    void rebuildTracking(); // recomputes the tracking state from the columns
+    void trackAppended(int first); // adds elements [first, count) to the tracking state
+};
+
+// Pre-Condition: count is non-negative; generator(i) returns a Lumen obeying the Lumen class
+//                invariants for 0 <= i < count
+// Post-Condition: the count Lumens generator returns are stored as the new last elements; if
+//                 generator throws, the bank keeps its old elements
+template <class Generator>
+void LumenBank::appendGenerated(int count, Generator generator) {
+    if (count <= 0) {
+        return;
+    }
+    growFor(count);
+    int first = this->count;
+    for (int i = 0; i < count; i++) {
+        writeLumen(first + i, generator(i));
+    }
+    this->count += count;
+    if (first == 0) {
+        rebuildTracking(); // a bulk build of the indexes beats count single inserts
+        return;
+    }
+    trackAppended(first);
+    markDirty(first, this->count);
+}
+
+#endif // LUMEN_BANK_H
+
+
+/*
+Class invariants for LumenBank:
+
+- 0 <= count <= cap; when cap is 0 the block and every column pointer are nullptr.
+- block == inlineBlock exactly when 0 < cap <= INLINELUMENS; otherwise a non-null block is a heap
+  allocation owned by the bank.
+- Every column points into block and holds cap elements; only the first count are meaningful.
+- Element i of every column together describes exactly the state of one Lumen and obeys the
+  Lumen class invariants.
+- Per-element operations behave exactly like the corresponding Lumen member functions.
+- glowOrder holds the current glow value of every element [0, count) under its index, and
+  stateIndex the ids of those elements in the bucket of their LumenState.
+- Every active element outside [dirtyBegin, dirtyEnd) has power == powerCopy and is charged.
+
+Class invariants for LumenRef:
+
+- bank points to a live LumenBank and 0 <= index < bank->size() for as long as the handle is used.
+*/
@@ -0,0 +1,68 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The LumenCell class keeps its constexpr transitions in the header; only the conversions to and
+from Lumen, which need Lumen's private fields, live here. The static_asserts below run the
+transitions at compile time, so a rule that drifts from Lumen's stops the build.
+
+ASSUMPTIONS:
+- A Lumen converted to a LumenCell obeys the Lumen class invariants.
+*/
+
+#include "lumen_cell.h"
+
+namespace {
+
+// Pre-Condition: n is non-negative
+// Post-Condition: returns the glow value of lumen after it has glowed n more times
+constexpr int glowValueAfter(LumenCell lumen, int n) {
+    for (int i = 0; i < n; i++) {
+        lumen.glow();
+    }
+    return lumen.currentGlowValue();
+}
+
+// brightness 10, size 2, power 10: powerThreshold 2, dimmingValue 1
+static_assert(glowValueAfter(LumenCell(10, 2, 10), 0) == 20, "an active lumen glows with brightness * size");
+static_assert(glowValueAfter(LumenCell(10, 2, 10), 8) == 20 * 12, "an erratic lumen glows with brightness * size * (power + 10)");
+static_assert(glowValueAfter(LumenCell(10, 2, 10), 10) == 1, "a dimmed lumen glows with its dimming value");
+
+} // namespace
+
+// Pre-Condition: None
+// Post-Condition: a LumenCell holding every field of lumen is created
+LumenCell::LumenCell(const Lumen& lumen)
+: brightness(lumen.brightness), size(lumen.size), power(lumen.power),
+  brightnessCopy(lumen.brightnessCopy), powerCopy(lumen.powerCopy),
+  dimmingValue(lumen.dimmingValue), powerThreshold(lumen.powerThreshold),
+  glowRequest(lumen.glowRequest), maxReset(lumen.maxReset), resetCount(lumen.resetCount),
+  charged(lumen.charged) {}
+
+// Pre-Condition: None
+// Post-Condition: Returns a Lumen with exactly the fields of this LumenCell
+Lumen LumenCell::toLumen() const {
+    Lumen lumen(1, 1, 1);
+    lumen.brightness = brightness;
+    lumen.size = size;
+    lumen.power = power;
+    lumen.brightnessCopy = brightnessCopy;
+    lumen.powerCopy = powerCopy;
+    lumen.dimmingValue = dimmingValue;
+    lumen.powerThreshold = powerThreshold;
+    lumen.glowRequest = glowRequest;
+    lumen.maxReset = maxReset;
+    lumen.resetCount = resetCount;
+    lumen.charged = charged;
+    return lumen;
+}
+
+
+/*
+Implementation Invariant:
+- LumenCell(const Lumen&) and toLumen() copy all eleven fields, so converting back and forth
+  loses nothing.
+*/
@@ -0,0 +1,158 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+LumenCell.h is the header file for the LumenCell class, a Lumen held by value whose state
+transitions (glow, reset, recharge) and queries are all constexpr. FixedNova stores its lumens
+as LumenCells in a std::array, so the compiler can inline and unroll every transition, and the
+same rules can be evaluated at compile time.
+
+A LumenCell follows the same rules as Lumen, with the glow values computed in unsigned
+arithmetic like the batch kernels. Unlike Lumen and LumenBank, it does not count resets in
+NovaMetrics: a constexpr transition cannot touch the per-thread counters.
+*/
+
+#ifndef LUMEN_CELL_H
+#define LUMEN_CELL_H
+
+#include <stdexcept>
+#include "lumen.h"
+
+class LumenCell {
+public:
+    constexpr LumenCell(int inputBrightness, int inputSize, int inputPower);
+    explicit LumenCell(const Lumen& lumen);
+
+    constexpr int glow();
+    constexpr bool reset();
+    constexpr void recharge();
+
+    constexpr bool isActive() const;
+    constexpr bool isErratic() const;
+    constexpr int currentGlowValue() const;
+
+    constexpr int getBrightness() const;
+    constexpr int getPower() const;
+    constexpr int getSize() const;
+
+    Lumen toLumen() const; // the equivalent Lumen, with every field set
+
+private:
+    int brightness;
+    int size;
+    int power;
+    int brightnessCopy;
+    int powerCopy;
+
+    int dimmingValue;
+    int powerThreshold;
+
+    int glowRequest;
+    int maxReset;
+    int resetCount;
+    bool charged;
+    static constexpr int INACTIVESTATE = 0;
+    static constexpr int RESETTHRESHOLD = 5;
+    static constexpr int ERRATICFACTOR = 10;
+};
+
+// Pre-Condition: inputBrightness, inputSize, and inputPower are positive
+// Post-Condition: a lumen with the given values is created, exactly like Lumen's constructor
+constexpr LumenCell::LumenCell(int inputBrightness, int inputSize, int inputPower)
+: brightness(inputBrightness), size(inputSize), power(inputPower),
+  brightnessCopy(inputBrightness), powerCopy(inputPower),
+  dimmingValue(static_cast<int>(inputBrightness * (10.0 / 100))),
+  powerThreshold(static_cast<int>(inputPower * (20.0 / 100))),
+  glowRequest(0), maxReset(inputSize * 3), resetCount(0), charged(false) {
+    if (inputBrightness <= 0 || inputSize <= 0 || inputPower <= 0) {
+        throw std::out_of_range("All input values for Lumen must be positive.");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the glow value after one glow, like Lumen::glow
+constexpr int LumenCell::glow() {
+    glowRequest++;
+    power--;
+    return currentGlowValue();
+}
+
+// Pre-Condition: None
+// Post-Condition: Resets the lumen if conditions are met, otherwise reduces brightness by 1
+constexpr bool LumenCell::reset() {
+    if (resetCount >= maxReset) {
+        return false;
+    }
+    if (glowRequest >= RESETTHRESHOLD && power > INACTIVESTATE) {
+        power = powerCopy;
+        brightness = brightnessCopy;
+        glowRequest = 0;
+        resetCount++;
+        return true;
+    }
+    brightness--;
+    return false;
+}
+
+// Pre-Condition: None
+// Post-Condition: power restored to its original value and charged set to true
+constexpr void LumenCell::recharge() {
+    power = powerCopy;
+    charged = true;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the lumen is active, otherwise false
+constexpr bool LumenCell::isActive() const {
+    return power > powerThreshold;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the lumen is erratic, otherwise false
+constexpr bool LumenCell::isErratic() const {
+    return power <= powerThreshold && power > INACTIVESTATE;
+}
+
+// Pre-Condition: None
+// Post-Condition: return brightness * size if the lumen is active, otherwise the erratic or dimming value
+constexpr int LumenCell::currentGlowValue() const {
+    unsigned litValue = static_cast<unsigned>(brightness) * static_cast<unsigned>(size);
+    if (isActive()) {
+        return static_cast<int>(litValue);
+    }
+    if (isErratic()) {
+        return static_cast<int>(litValue * static_cast<unsigned>(power + ERRATICFACTOR));
+    }
+    return dimmingValue;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the brightness of the lumen
+constexpr int LumenCell::getBrightness() const {
+    return brightness;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the power of the lumen
+constexpr int LumenCell::getPower() const {
+    return power;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the size of the lumen
+constexpr int LumenCell::getSize() const {
+    return size;
+}
+
+#endif // LUMEN_CELL_H
+
+
+/*
+Class invariants for LumenCell:
+
+- Every field has the meaning and obeys the invariants of the Lumen field of the same name.
+- Every transition leaves the same field values as the same Lumen member function.
+*/
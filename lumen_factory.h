@@ -0,0 +1,122 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+LumenFactory.h holds the compile-time factory policies that build the lumens of a new Nova.
+ILuminosity::illuminate is a virtual call that hands back one heap Lumen, so building a Nova
+through it costs a virtual call, a new and a delete per lumen. A factory policy is a plain class
+that the Nova constructor template takes by type, so its calls are resolved and inlined at
+compile time. Every policy offers:
+- Lumen illuminate(int brightness, int size, int power) const: one lumen, by value.
+- LumenBank illuminateBatch(int count, Generator generator) const: count lumens, where
+  generator(i) returns the LumenValues of lumen i, built into one contiguous LumenBank.
+
+DirectLuminosity builds the lumens in place: one allocation for the whole bank and one pass over
+it. LuminosityAdapter puts a runtime ILuminosity behind the same interface, so injected factories
+(mocks, PooledLuminosity) still see one illuminate and one extinguish per lumen.
+*/
+
+#ifndef LUMEN_FACTORY_H
+#define LUMEN_FACTORY_H
+
+#include "nova.h"
+
+// The arguments of one illuminate call
+struct LumenValues {
+    int brightness;
+    int size;
+    int power;
+};
+
+class DirectLuminosity {
+public:
+    Lumen illuminate(int brightness, int size, int power) const;
+    template <class Generator>
+    LumenBank illuminateBatch(int count, Generator generator) const;
+};
+
+class LuminosityAdapter {
+public:
+    explicit LuminosityAdapter(ILuminosity* luminate);
+
+    Lumen illuminate(int brightness, int size, int power) const;
+    template <class Generator>
+    LumenBank illuminateBatch(int count, Generator generator) const;
+
+private:
+    ILuminosity* luminate;
+};
+
+// Pre-Condition: brightness, size, and power are positive
+// Post-Condition: Returns a new Lumen with these values
+inline Lumen DirectLuminosity::illuminate(int brightness, int size, int power) const {
+    return Lumen(brightness, size, power);
+}
+
+// Pre-Condition: count is non-negative; generator(i) returns positive values for 0 <= i < count
+// Post-Condition: Returns a bank holding the count lumens, allocated once and written in one pass
+template <class Generator>
+LumenBank DirectLuminosity::illuminateBatch(int count, Generator generator) const {
+    LumenBank lumens;
+    lumens.reserve(count);
+    lumens.appendGenerated(count, [this, &generator](int i) {
+        LumenValues values = generator(i);
+        return illuminate(values.brightness, values.size, values.power);
+    });
+    return lumens;
+}
+
+// Pre-Condition: luminate outlives the adapter
+// Post-Condition: an adapter building lumens through luminate is created
+inline LuminosityAdapter::LuminosityAdapter(ILuminosity* luminate) : luminate(luminate) {}
+
+// Pre-Condition: brightness, size, and power are positive
+// Post-Condition: Returns a copy of the Lumen luminate builds, which is handed straight back to it
+inline Lumen LuminosityAdapter::illuminate(int brightness, int size, int power) const {
+    Lumen* lumen = luminate->illuminate(brightness, size, power);
+    Lumen copy = *lumen;
+    luminate->extinguish(lumen);
+    return copy;
+}
+
+// Pre-Condition: count is non-negative; generator(i) returns positive values for 0 <= i < count
+// Post-Condition: Returns a bank holding the count lumens, each illuminated and extinguished
+//                 through luminate in index order; the bank's indexes are built once at the end
+template <class Generator>
+LumenBank LuminosityAdapter::illuminateBatch(int count, Generator generator) const {
+    LumenBank lumens;
+    lumens.reserve(count);
+    lumens.appendGenerated(count, [this, &generator](int i) {
+        LumenValues values = generator(i);
+        return illuminate(values.brightness, values.size, values.power);
+    });
+    return lumens;
+}
+
+// Pre-Condition: initial brightness, size, power and numLumens are positive; luminate outlives the Nova
+// Post-Condition: lumen i is built by factory from brightness + i, size + i and power + i * 10;
+//                 lumens added later are illuminated through luminate
+template <class Factory>
+Nova::Nova(ILuminosity* luminate, const Factory& factory, int initialBrightness, int initialSize,
+           int initialPower, int numLumens)
+: Nova(luminate) {
+    if (initialBrightness <= 0 || initialSize <= 0 || initialPower <= 0 || numLumens <= 0) {
+        throw std::out_of_range("All input values for Nova must be positive.");
+    }
+    adoptBank(factory.illuminateBatch(numLumens, [=](int i) {
+        return LumenValues{initialBrightness + i, initialSize + i, initialPower + i * 10};
+    }));
+}
+
+#endif // LUMEN_FACTORY_H
+
+
+/*
+Class invariants for the factory policies:
+
+- illuminateBatch builds exactly the lumens count calls of illuminate would, in index order.
+- LuminosityAdapter hands every Lumen it gets from luminate back to luminate before returning.
+*/
@@ -20,6 +20,59 @@ NOTE: recharge() function was implemented as it will internally recharge if more
 the Nova are inactive and it will recharge lumens that are stable within the Nova.
 
 
+NOTE: Nova + Nova and Nova - Nova are expression templates (nova_expr.h). A chain such as
+a + b - c is evaluated in one elementwise pass when it becomes a Nova, with no intermediate Novas.
+Comparisons and queries such as (a + b) == c or (a + b).minGlow() materialize the expression first.
+
+
+NOTE: copies of a Nova share its lumen bank (copy-on-write). The bank is cloned the first time
+either side changes it, so snapshot copies that are only read never copy a lumen. A Nova that
+handed out a LumenRef through lumen(i) gives its copies their own bank right away, since the
+handle could otherwise change the copy.
+
+
+NOTE: the lumen storage grows geometrically, so ++, += and append() cost amortized O(1) per
+added lumen; reserve() and shrinkToFit() control the capacity explicitly. truncate() and the
+integer/Nova forms of - and -= drop lumens in one step instead of calling -- repeatedly.
++= copies the other Nova one column at a time. append(std::move(other)) is += other followed by
+freeing other, so it is an O(m) copy of other's m lumens like any append. Only an empty Nova takes
+other's bank as is, without copying a lumen; a Nova that already has lumens cannot splice other's
+columns onto its own, since every column is one contiguous array the glow kernels stream through.
+
+
+NOTE: glowTicks(x, k) fast-forwards k calls of glow(x). The inactive count never drops during a
+run of glows, so there is at most one tick at which recharging starts; before it the lumens only
+dim, after it every tick recharges. Both runs are advanced in closed form, one pass each.
+
+
+NOTE: parallelGlow(pool, threshold) lets glow(x) with x >= threshold split the glowing lumens
+over a WorkStealingPool, and the recharge pass is split the same way. Each task only records which
+of its lumens changed state; once the pool has joined, the calling thread moves those lumens in the
+state index and the glow order serially, so the result is exactly that of the sequential glow. The
+lock-free reduction of per-task state counters was dropped when the counters became the StateIndex
+buckets: those buckets hold lumen ids, which cannot be summed across tasks.
+
+
+NOTE: glowStats() computes count, sum, mean, min, max, a histogram and approximate percentiles
+in one pass: the glow values are produced a block at a time by the SIMD kernel and folded into
+the GlowStats before the next block. addGlowStats(stats) folds the values into a GlowStats the
+caller already has, which is how NovaEngine fills one GlowStats per group of Novas.
+glowPercentile(q) is exact and selects the rank from all glow values instead.
+
+
+NOTE: Nova implements INova, the interface it shares with FixedNova<N> (fixed_nova.h), which
+keeps a compile-time number of lumens inline. currentGlowValue(i) reads one lumen in place,
+without pinning the bank the way lumen(i) does.
+
+
+NOTE: the lumens of a Nova are stored column by column in a LumenBank rather than as an array of
+Lumen pointers. Every lumen is created by the injected ILuminosity factory, copied into the bank and
+handed back to the factory with extinguish(); lumen(i) hands out a LumenRef for per-element access.
+A Nova of up to 16 lumens keeps its columns and its state index inside the bank object itself, so a
+small Nova built with DirectLuminosity makes a single allocation, the block it shares with its
+copies, and its glows allocate nothing; ++ and += past 16 lumens move them to the heap.
+
+
 NOTE: 
 - When adding a Nova to another Nova with the + operator, we are adding the contents of the Nova, meaning the lumens will get added up.
 - When subtracting a Nova from another Nova, we are subtracting the values within the Nova, meaning the Lumens' values. If it is negative or 0, they are set to 1.
@@ -32,28 +85,31 @@ e.g novas + 5
 */
 
 #include "nova.h"
+#include "work_stealing_pool.h"
 #include <stdexcept>
 #include <iostream>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+// Lumen bank shared by a Nova and its copies; owners counts the Novas pointing at it
+struct Nova::SharedLumens {
+    LumenBank bank;
+    std::atomic<int> owners{1};
+};
 
 /************************************ Nova Constructors *******************************************/
 
 // Pre-Condition: initial brightness, size, and power should not be negative; should be positive
 // Post-Condition: first lumen is initialized along with the rest of the lumens for the nova
-Nova::Nova(ILuminosity* luminate, int initialBrightness, int initialSize, int initialPower, int numLumens) {
-    if (initialBrightness <= 0 || initialSize <= 0 || initialPower <= 0 || numLumens <=0) {
-        throw std::out_of_range("All input values for Nova must be positive.");
-    }
-    this->numLumens = numLumens;
-    this->luminate = luminate;
-    lumens = new Lumen*[numLumens];
+Nova::Nova(ILuminosity* luminate, int initialBrightness, int initialSize, int initialPower, int numLumens)
+: Nova(luminate, LuminosityAdapter(luminate), initialBrightness, initialSize, initialPower, numLumens) {}
 
-    for (int i = 0; i < numLumens; i++) {
-        int brightness = initialBrightness + i;
-        int size = initialSize + i;
-        int power = initialPower + i * 10;
-        lumens[i] = luminate->illuminate(brightness, size, power);
-    }
-}
+// Pre-Condition: None
+// Post-Condition: an empty Nova that illuminates through luminate is created
+Nova::Nova(ILuminosity* luminate)
+: luminate(luminate), lumens(nullptr), lumensPinned(false), glowPool(nullptr), glowThreshold(0) {}
 
 // Pre-Condition: None
 // Post-Condition: Frees Memory
@@ -64,7 +120,7 @@ Nova::~Nova() {
 // Copy Nova
 // Pre-Condition: other must be a valid Nova object
 // Post-Condition: Creates a copy of the other Nova object
-Nova::Nova(const Nova& other) {
+Nova::Nova(const Nova& other) : lumens(nullptr), lumensPinned(false) {
     copyLumens(other);
 }
 
@@ -83,10 +139,8 @@ Nova& Nova::operator=(const Nova& other) {
 // Move constructor
 // Pre-Condition: other must be a valid Nova object
 // Post-Condition: The current Nova object takes ownership of the other Nova object's resources, and other's resources are reset
-Nova::Nova(Nova&& other) noexcept
-: numLumens(other.numLumens), lumens(other.lumens) {
-    other.numLumens = 0;
-    other.lumens = nullptr;
+Nova::Nova(Nova&& other) noexcept : lumens(nullptr), lumensPinned(false) {
+    moveLumens(std::move(other));
 }
 
 // Move assignment operator
@@ -95,15 +149,10 @@ Nova::Nova(Nova&& other) noexcept
 Nova& Nova::operator=(Nova&& other) noexcept {
     if (this != &other) {
         // Release the resources of the current object
-        delete[] lumens;
+        freeMemory();
 
         // Transfer ownership of resources from the source object
-        numLumens = other.numLumens;
-        lumens = other.lumens;
-
-        // Reset the source object's resource pointers
-        other.numLumens = 0;
-        other.lumens = nullptr;
+        moveLumens(std::move(other));
     }
     return *this;
 }
@@ -111,11 +160,14 @@ Nova& Nova::operator=(Nova&& other) noexcept {
 // Precondition: 'other' is an instance of Nova that can be compared with 'this' instance
 // Postcondition: returns true if both instances are the same, false otherwise
 bool Nova::operator==(const Nova& other) const{
-    if (this->numLumens != other.numLumens) {
+    if (bank().size() != other.bank().size()) {
         return false;
     }
-    for (int i = 0; i < numLumens; i++) {
-        if (!(*this->lumens[i] == *other.lumens[i])) {
+    if (lumens == other.lumens) {
+        return true; // sharing one bank
+    }
+    for (int i = 0; i < bank().size(); i++) {
+        if (!bank().sameValues(i, other.bank(), i)) {
             return false;
         }
     }
@@ -131,13 +183,13 @@ bool Nova::operator!=(const Nova& other) const{
 // Precondition: 'other' is an instance of Nova that can be compared with 'this' instance
 // Postcondition: returns true if 'this' instance has fewer lumens than 'other', false otherwise
 bool Nova::operator<(const Nova& other) const{
-    return numLumens < other.numLumens;
+    return bank().size() < other.bank().size();
 }
 
 // Precondition: 'other' is an instance of Nova that can be compared with 'this' instance
 // Postcondition: returns true if 'this' instance has more lumens than 'other', false otherwise
 bool Nova::operator>(const Nova& other) const{
-    return numLumens > other.numLumens;
+    return bank().size() > other.bank().size();
 }
 
 // Precondition: 'other' is an instance of Nova that can be compared with 'this' instance
@@ -152,58 +204,16 @@ bool Nova::operator>=(const Nova& other) const{
     return !(*this < other);
 }
 
-// Precondition: 'other' is an instance of Nova with the same number of lumens as 'this' instance
-// Postcondition: returns a new Nova instance that is the sum of 'this' and 'other' instance
-Nova Nova::operator+(const Nova& other) const{
-    // Ensure that Nova1 and Nova2 have the same number of lumens
-    if (this->numLumens != other.numLumens) {
-        throw std::invalid_argument("Nova objects must have the same number of lumens to be added together.");
-    }
-
-    // New size is the size of either Nova (since they have the same size)
-    int newSize = this->numLumens;
-
-    // Create a new Nova with arbitrary initial brightness, size, and power.
-    // The new Nova won't actually own any Lumen objects yet.
-    Nova result(this->luminate, 1, newSize, 1, newSize);
-
-    // Add the properties of corresponding Lumen objects in Nova1 and Nova2
-    for (int i = 0; i < newSize; i++) {
-        int newBrightness = this->lumens[i]->getBrightness() + other.lumens[i]->getBrightness();
-        int newSize = this->lumens[i]->getSize() + other.lumens[i]->getSize();
-        int newPower = this->lumens[i]->getPower() + other.lumens[i]->getPower();
-        
-        result.lumens[i] = this->luminate->illuminate(newBrightness, newSize, newPower);
-    }
-
-    return result;
-} // standard
-
 // Precondition: 'value' is an integer to be added to 'this' instance
 // Postcondition: returns a new Nova instance that has 'value' number of new lumens added
 Nova Nova::operator+(int value) const{
-    // Create a copy of the current Nova.
+    // Share the current lumens, then copy them once into storage with room for the new ones.
     Nova result(*this);
+    result.ownBank(value > 0 ? value : 0);
     
     // Add the specified number of default Lumens.
     for (int i = 0; i < value; i++) {
-        Lumen* newLumen = new Lumen(1, result.numLumens + i, 1);
-
-        // Dynamically allocate a new array to hold the expanded Lumens.
-        Lumen** newLumens = new Lumen*[result.numLumens + 1];
-        
-        // Copy the old Lumens over.
-        for (int j = 0; j < result.numLumens; j++) {
-            newLumens[j] = result.lumens[j];
-        }
-
-        // Add the new Lumen.
-        newLumens[result.numLumens] = newLumen;
-        
-        // Clean up and update properties.
-        delete[] result.lumens;
-        result.lumens = newLumens;
-        result.numLumens += 1;
+        result.adoptLumen(result.luminate->illuminate(1, result.bank().size() + i, 1));
     }
 
     return result;
@@ -214,24 +224,11 @@ Nova Nova::operator+(int value) const{
 // Postcondition: 'this' instance has been modified to include the lumens from 'other' instance
 Nova& Nova::operator+=(const Nova& other){
     // This operation will simply extend the current Nova by adding the contents of the other Nova.
-    // We'll need to dynamically allocate a new array, copy the contents over, and then clean up.
-    int newSize = this->numLumens + other.numLumens;
-    Lumen** newLumens = new Lumen*[newSize];
+    int otherSize = other.bank().size();
+    LumenBank& own = ownBank(otherSize);
     
-    // Copy contents of the current Nova.
-    for (int i = 0; i < this->numLumens; i++) {
-        newLumens[i] = this->lumens[i];
-    }
-    
-    // Copy contents of the other Nova.
-    for (int i = 0; i < other.numLumens; i++) {
-        newLumens[i + this->numLumens] = other.lumens[i];
-    }
-    
-    // Clean up and update properties.
-    delete[] this->lumens;
-    this->lumens = newLumens;
-    this->numLumens = newSize;
+    // Copy the columns of the other Nova in one block each (other may share or be this bank).
+    own.append(other.bank());
     
     return *this;
 } // shortcut standard
@@ -239,23 +236,7 @@ Nova& Nova::operator+=(const Nova& other){
 // Precondition: 'value' is an integer indicating the number of new lumens to be added to 'this' instance
 // Postcondition: 'this' instance has been modified to include 'value' number of new lumens
 Nova& Nova::operator+=(int value){
-    int newSize = this->numLumens + value;
-    Lumen** newLumens = new Lumen*[newSize];
-    
-    // Copy contents of the current Nova.
-    for (int i = 0; i < this->numLumens; i++) {
-        newLumens[i] = this->lumens[i];
-    }
-    
-    // Add new Lumens.
-    for (int i = this->numLumens; i < newSize; i++) {
-        newLumens[i] = new Lumen(1, i, 1); // Assuming this creates a default Lumen.
-    }
-    
-    // Clean up and update properties.
-    delete[] this->lumens;
-    this->lumens = newLumens;
-    this->numLumens = newSize;
+    append(value);
     
     return *this;
 } // shortcut mixed mode
@@ -265,21 +246,7 @@ Nova& Nova::operator+=(int value){
 // Postcondition: 'this' instance has been modified to include one new default lumen
 Nova& Nova::operator++(){
     // In this case, we will just add one default Lumen to the current Nova.
-    int newSize = this->numLumens + 1;
-    Lumen** newLumens = new Lumen*[newSize];
-    
-    // Copy contents of the current Nova.
-    for (int i = 0; i < this->numLumens; i++) {
-        newLumens[i] = this->lumens[i];
-    }
-    
-    // Add new Lumen.
-    newLumens[this->numLumens] = new Lumen(1, this->numLumens, 1); 
-    
-    // Clean up and update properties.
-    delete[] this->lumens;
-    this->lumens = newLumens;
-    this->numLumens = newSize;
+    adoptLumen(luminate->illuminate(1, bank().size(), 1));
     
     return *this;
 } // prefix increment
@@ -297,39 +264,10 @@ Nova Nova::operator++(int){
     return copy;
 } // postfix increment
 
-// Precondition: 'other' is an instance of Nova with equal or fewer number of lumens as 'this' instance
-// Postcondition: returns a new Nova instance that is the result of subtracting 'other' instance from 'this' instance
-Nova Nova::operator-(const Nova& other) const{
-    if (this->numLumens != other.numLumens) {
-        throw std::out_of_range("Cannot subtract Novas with different numbers of Lumens.");
-    }
-
-    // Create a new Nova to hold the result.
-    Nova result(*this);
-
-    // Subtract each Lumen.
-    for (int i = 0; i < numLumens; i++) {
-        int brightness = this->lumens[i]->getBrightness() - other.lumens[i]->getBrightness();
-        int size = this->lumens[i]->getSize() - other.lumens[i]->getSize();
-        int power = this->lumens[i]->getPower() - other.lumens[i]->getPower();
-
-        // If any properties are zero or negative, set them to 1.
-        if (brightness <= 0) brightness = 1;
-        if (size <= 0) size = 1;
-        if (power <= 0) power = 1;
-
-        // Set the properties of the Lumen in the result Nova.
-        delete result.lumens[i];
-        result.lumens[i] = new Lumen(brightness, size, power);
-    }
-
-    return result;
-} // standard
-
 // Precondition: 'value' is an integer less than or equal to the number of lumens in 'this' instance
 // Postcondition: returns a new Nova instance that is the result of subtracting 'value' lumens from 'this' instance
 Nova Nova::operator-(int value) const{
-    if (value >= numLumens) {
+    if (value >= bank().size()) {
         throw std::runtime_error("Cannot subtract more lumens than the Nova object contains.");
     }
 
@@ -337,9 +275,7 @@ Nova Nova::operator-(int value) const{
     Nova novaCopy(*this);
 
     // Remove lumens from the copy.
-    for (int i = 0; i < value; i++) {
-        --novaCopy;
-    }
+    novaCopy.truncate(value);
 
     return novaCopy;
 } // mixed mode 
@@ -347,14 +283,12 @@ Nova Nova::operator-(int value) const{
 // Precondition: 'other' is an instance of Nova with equal or fewer number of lumens as 'this' instance
 // Postcondition: 'this' instance has been modified by subtracting the lumens from 'other' instance
 Nova& Nova::operator-=(const Nova& other){
-    if (other.numLumens > numLumens) {
+    if (other.bank().size() > bank().size()) {
         throw std::runtime_error("Cannot subtract a larger Nova from a smaller one.");
     }
 
     // Subtract other's lumens from this Nova's lumens.
-    for (int i = 0; i < other.numLumens; i++) {
-        --(*this);
-    }
+    truncate(other.bank().size());
 
     return *this;
 } // shortcut standard
@@ -362,14 +296,12 @@ Nova& Nova::operator-=(const Nova& other){
 // Precondition: 'value' is an integer less than or equal to the number of lumens in 'this' instance
 // Postcondition: 'this' instance has been modified by subtracting 'value' lumens
 Nova& Nova::operator-=(int value){
-    if (value > numLumens) {
+    if (value > bank().size()) {
         throw std::runtime_error("Cannot subtract more lumens than the Nova object contains.");
     }
 
     // Subtract value lumens from this Nova.
-    for (int i = 0; i < value; i++) {
-        --(*this);
-    }
+    truncate(value);
 
     return *this;
 } // shortcut mixed mode
@@ -377,26 +309,12 @@ Nova& Nova::operator-=(int value){
 // Precondition: 'this' instance has at least one lumen
 // Postcondition: 'this' instance has been modified by subtracting one lumen
 Nova& Nova::operator--(){
-    if (numLumens <= 0) {
+    if (bank().size() <= 0) {
         throw std::runtime_error("Cannot decrement: no lumens in the Nova object.");
     }
-    
-    Lumen** newLumens = new Lumen*[numLumens - 1];
 
-    // Copy all but the last Lumen.
-    for (int i = 0; i < numLumens - 1; i++) {
-        newLumens[i] = lumens[i];
-    }
-
-    // Delete the last Lumen and free its memory.
-    delete lumens[numLumens - 1];
-    
-    // Free the old array and update the lumens pointer.
-    delete[] lumens;
-    lumens = newLumens;
-
-    // Decrement the lumen count.
-    --numLumens;
+    // Drop the last Lumen.
+    ownBank().removeLast();
 
     return *this;
 
@@ -419,111 +337,374 @@ Nova Nova::operator--(int){
 // Pre-Condition: x should be a non-negative integer and less than or equal to the number of lumens
 // Post-Condition: The first x lumens are made to glow, and inactive lumens are recharged if necessary
 void Nova::glow(int x) {
-    if (x < 0 || x > numLumens) {
+    if (x < 0 || x > bank().size()) {
         throw std::out_of_range("Invalid number of lumens to glow.");
     }
-    for (int i = 0; i < x; i++) {
-        if (lumens[i])
-        lumens[i]->glow();
+    NovaMetrics::add(NovaCounter::NovaGlows);
+    if (glowPool && x >= glowThreshold) {
+        ownBank().glowFirst(x, *glowPool);
+    } else {
+        ownBank().glowFirst(x);
     }
     rechargeInactiveLumens();
 }
 
+// Pre-Condition: pool is nullptr or outlives this Nova; threshold is non-negative
+// Post-Condition: glow(x) with x >= threshold runs on pool from now on; nullptr glows sequentially
+void Nova::parallelGlow(WorkStealingPool* pool, int threshold) {
+    if (threshold < 0) {
+        throw std::out_of_range("Invalid parallel glow threshold.");
+    }
+    glowPool = pool;
+    glowThreshold = threshold;
+}
+
+// Pre-Condition: x should be a non-negative integer and less than or equal to the number of lumens;
+//                ticks should be non-negative
+// Post-Condition: The Nova is in exactly the state ticks calls of glow(x) would leave it in
+void Nova::glowTicks(int x, int ticks) {
+    if (x < 0 || x > bank().size()) {
+        throw std::out_of_range("Invalid number of lumens to glow.");
+    }
+    if (ticks < 0) {
+        throw std::out_of_range("Invalid number of glow ticks.");
+    }
+
+    if (ticks == 0) {
+        return;
+    }
+    NovaMetrics::add(NovaCounter::NovaGlows, ticks);
+    LumenBank& own = ownBank();
+
+    // Until the first recharge every tick only dims the first x lumens
+    int firstRecharge = own.ticksUntilInactive(x, own.size() / 2 + 1);
+    if (firstRecharge < 0 || firstRecharge > ticks) {
+        own.glowFirst(x, ticks);
+        return;
+    }
+    own.glowFirst(x, firstRecharge);
+    own.rechargeActive();
+    // every tick from the first recharge on recharges as well
+    NovaMetrics::add(NovaCounter::RechargeRounds, ticks - firstRecharge + 1);
+
+    // Inactive lumens are never recharged, so from now on every tick recharges
+    own.glowFirstAndRecharge(x, ticks - firstRecharge);
+}
+
+// Pre-Condition: lumen was returned by luminate->illuminate
+// Post-Condition: lumen's state is appended to the bank and the standalone object is given back to the factory
+void Nova::adoptLumen(Lumen* lumen) {
+    ownBank(1).append(*lumen);
+    luminate->extinguish(lumen);
+}
+
+// Pre-Condition: this Nova holds no lumens
+// Post-Condition: bank becomes the lumen bank of this Nova
+void Nova::adoptBank(LumenBank&& bank) {
+    lumens = new SharedLumens{std::move(bank)};
+}
 
 // Pre-Condition: other must be a valid Nova object
-// Post-Condition: Creates a deep copy of the lumens from the other Nova object into the 
+// Post-Condition: this Nova shares other's lumen bank; it is copied on the first change to either
+//                 (right away if other handed out LumenRefs into it)
 void Nova::copyLumens(const Nova& other) {
-    numLumens = other.numLumens;
-    lumens = new Lumen*[numLumens];
-    for (int i = 0; i < numLumens; i++) {
-        lumens[i] = new Lumen(*other.lumens[i]);
+    luminate = other.luminate;
+    glowPool = other.glowPool;
+    glowThreshold = other.glowThreshold;
+    if (other.lumensPinned && other.lumens) {
+        lumens = new SharedLumens{other.lumens->bank};
+    } else {
+        lumens = other.lumens;
+        if (lumens) {
+            lumens->owners.fetch_add(1, std::memory_order_relaxed);
+        }
     }
+    lumensPinned = false;
 }
 
 // Pre-Condition: other must be a valid Nova object
 // Post-Condition: Transfers ownership of lumens from the other Nova object to the current 
 void Nova::moveLumens(Nova&& other) noexcept {
-    numLumens = other.numLumens;
+    luminate = other.luminate;
+    glowPool = other.glowPool;
+    glowThreshold = other.glowThreshold;
     lumens = other.lumens;
-    other.numLumens = 0;
     other.lumens = nullptr;
+    lumensPinned = other.lumensPinned;
+    other.lumensPinned = false;
 }
 
-// Pre-Condition: lumens must be a valid array of Lumen pointers
-// Post-Condition: Frees the memory allocated for the lumens and their array
+// Pre-Condition: None
+// Post-Condition: this Nova lets go of its lumen bank; the bank is freed once no copy shares it
 void Nova::freeMemory() {
-    for (int i = 0; i < numLumens; i++) {
-        delete lumens[i];
+    if (lumens && lumens->owners.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete lumens;
     }
-    delete[] lumens;
+    lumens = nullptr;
+    lumensPinned = false;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the lumens of this Nova for reading (an empty bank if there are none)
+const LumenBank& Nova::bank() const {
+    static const LumenBank noLumens;
+    return lumens ? lumens->bank : noLumens;
+}
+
+// Pre-Condition: extra is non-negative
+// Post-Condition: returns a bank owned by this Nova alone, with room for extra more lumens;
+//                 a bank shared with copies is cloned first, so they keep the old lumens
+LumenBank& Nova::ownBank(int extra) {
+    if (!lumens) {
+        lumens = new SharedLumens();
+        lumens->bank.reserve(extra);
+    } else if (lumens->owners.load(std::memory_order_acquire) > 1) {
+        // acquire: a copy that just let go of the bank has finished reading it
+        SharedLumens* own = new SharedLumens();
+        own->bank.reserve(std::max(lumens->bank.size() + extra, lumens->bank.capacity()));
+        own->bank = lumens->bank;
+        bool pinned = lumensPinned;
+        freeMemory();
+        lumens = own;
+        lumensPinned = pinned;
+    } else {
+        lumens->bank.growFor(extra);
+    }
+    return lumens->bank;
 }
 
 // Pre-Condition: None
 // Post-Condition: Returns the minimum glow value among all lumens in the Nova object
 int Nova::minGlow() const {
     // If there are no lumens, return an appropriate value or error
-    if(numLumens == 0) {
+    if(bank().size() == 0) {
         throw std::runtime_error("No lumens in the Nova object.");
     }
 
-    // Assume the first lumen has the minimum glow value
-    int minGlowValue = lumens[0]->currentGlowValue();
-
-    for (int i = 1; i < numLumens; i++) {
-        int currentGlowValue = lumens[i]->currentGlowValue();
-        if (currentGlowValue < minGlowValue) {
-            minGlowValue = currentGlowValue;
-        }
-    }
-
-    return minGlowValue;
+    return bank().minGlowValue();
 }
 
 // Pre-Condition: None
 // Post-Condition: Returns the maximum glow value among all lumens in the Nova object
 int Nova::maxGlow() const {
     // If there are no lumens, return an appropriate value or error
-    if(numLumens == 0) {
+    if(bank().size() == 0) {
         throw std::runtime_error("No lumens in the Nova object.");
     }
 
-    // Assume the first lumen has the maximum glow value
-    int maxGlowValue = lumens[0]->currentGlowValue();
+    return bank().maxGlowValue();
+}
 
-    for (int i = 1; i < numLumens; i++) {
-        int currentGlowValue = lumens[i]->currentGlowValue();
-        if (currentGlowValue > maxGlowValue) {
-            maxGlowValue = currentGlowValue;
-        }
+// Pre-Condition: k is non-negative
+// Post-Condition: Returns the min(k, number of lumens) brightest lumens with their indices, brightest first
+std::vector<LumenGlow> Nova::topK(int k) const {
+    if (k < 0) {
+        throw std::out_of_range("Invalid number of lumens to list.");
+    }
+    return bank().brightest(k);
+}
+
+// Pre-Condition: k is non-negative
+// Post-Condition: Returns the min(k, number of lumens) dimmest lumens with their indices, dimmest first
+std::vector<LumenGlow> Nova::bottomK(int k) const {
+    if (k < 0) {
+        throw std::out_of_range("Invalid number of lumens to list.");
     }
+    return bank().dimmest(k);
+}
 
-    return maxGlowValue;
+// Pre-Condition: None
+// Post-Condition: Returns the statistics of the current glow values of all lumens; they are
+//                 empty (count() == 0) for a Nova without lumens
+GlowStats Nova::glowStats() const {
+    GlowStats stats;
+    bank().addGlowStats(stats);
+    return stats;
+}
+
+// Pre-Condition: None
+// Post-Condition: stats also counts the current glow value of every lumen of this Nova
+void Nova::addGlowStats(GlowStats& stats) const {
+    bank().addGlowStats(stats);
+}
+
+// Pre-Condition: 0 <= q <= 1
+// Post-Condition: Returns the glow value of nearest rank ceil(q * number of lumens), exactly
+int Nova::glowPercentile(double q) const {
+    if(bank().size() == 0) {
+        throw std::runtime_error("No lumens in the Nova object.");
+    }
+    if (!(q >= 0.0 && q <= 1.0)) {
+        throw std::out_of_range("Invalid percentile.");
+    }
+
+    long long rank = static_cast<long long>(std::ceil(q * bank().size()));
+    return bank().glowValueAtRank(rank < 1 ? 1 : rank);
 }
 
 // Pre-Condition: None
 // Post-Condition: Recharges inactive lumens if more than half of the lumens in the Nova object are inactive
 void Nova::rechargeInactiveLumens() {
-    int inactive_count = 0;
-    // Count the number of inactive lumens
-    for (int i = 0; i < numLumens; i++) {
-        if (!lumens[i]->isActive()) {
-            inactive_count++;
-        }
-    }
+    // The bank keeps the number of inactive lumens up to date, so this is O(1)
+    int inactive_count = bank().countInactive();
+
     // Recharge lumens if more than half are inactive
-    if (inactive_count > numLumens / 2) {
-        for (int i = 0; i < numLumens; i++) {
-            if (!lumens[i]->isErratic() && lumens[i]->isActive()) {
-                lumens[i]->recharge();
-            }
+    if (inactive_count > bank().size() / 2) {
+        NovaMetrics::add(NovaCounter::RechargeRounds);
+        if (glowPool && bank().size() >= glowThreshold) {
+            ownBank().rechargeActive(*glowPool);
+        } else {
+            ownBank().rechargeActive();
         }
     }
 }
 
 // Precondition: none
 // Postcondition: returns the number of lumens within a Nova
-int Nova::getNumLumens(){
-    return numLumens;
+int Nova::getNumLumens() const{
+    return bank().size();
+}
+
+// Precondition: 0 <= index < getNumLumens()
+// Postcondition: returns the current glow value of lumen index, without pinning the lumens like lumen(index)
+int Nova::currentGlowValue(int index) const{
+    if (index < 0 || index >= bank().size()) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    return bank().currentGlowValue(index);
+}
+
+// Precondition: none
+// Postcondition: returns the number of active lumens within a Nova
+int Nova::getNumActiveLumens() const{
+    return bank().countActive();
+}
+
+// Precondition: none
+// Postcondition: returns the number of erratic lumens within a Nova
+int Nova::getNumErraticLumens() const{
+    return bank().countErratic();
+}
+
+// Precondition: none
+// Postcondition: returns the number of inactive (erratic or dimmed) lumens within a Nova
+int Nova::getNumInactiveLumens() const{
+    return bank().countInactive();
+}
+
+// Precondition: none
+// Postcondition: returns the indices of the active lumens, valid until the Nova changes
+LumenIdRange Nova::activeLumens() const{
+    return bank().lumensIn(LumenState::Active);
+}
+
+// Precondition: none
+// Postcondition: returns the indices of the erratic lumens, valid until the Nova changes
+LumenIdRange Nova::erraticLumens() const{
+    return bank().lumensIn(LumenState::Erratic);
+}
+
+// Precondition: none
+// Postcondition: returns the indices of the dimmed lumens, valid until the Nova changes
+LumenIdRange Nova::dimmedLumens() const{
+    return bank().lumensIn(LumenState::Dimmed);
+}
+
+// Precondition: none
+// Postcondition: returns the indices of the inactive (erratic or dimmed) lumens, valid until the Nova changes
+LumenIdRange Nova::inactiveLumens() const{
+    return bank().inactiveLumens();
+}
+
+// Precondition: none
+// Postcondition: returns the number of lumens the Nova can hold before it has to grow its storage
+int Nova::capacity() const{
+    return bank().capacity();
+}
+
+// Precondition: numLumens is non-negative
+// Postcondition: the Nova can hold at least numLumens lumens without growing its storage
+void Nova::reserve(int numLumens){
+    if (numLumens < 0) {
+        throw std::out_of_range("Cannot reserve a negative number of lumens.");
+    }
+    LumenBank& own = ownBank();
+    own.reserve(numLumens);
+}
+
+// Precondition: none
+// Postcondition: storage the Nova does not need for its current lumens is given back
+void Nova::shrinkToFit(){
+    // A bank shared with copies is left alone; this Nova does not own its spare room
+    if (lumens && lumens->owners.load(std::memory_order_acquire) == 1) {
+        lumens->bank.shrinkToFit();
+    }
+}
+
+// Precondition: none; a non-positive count adds nothing
+// Postcondition: count default lumens are added, the same ones count calls of ++ would add
+void Nova::append(int count){
+    if (count <= 0) {
+        return;
+    }
+    int newSize = bank().size() + count;
+    ownBank(count);
+
+    for (int i = bank().size(); i < newSize; i++) {
+        adoptLumen(luminate->illuminate(1, i, 1));
+    }
+}
+
+// Precondition: count is at most the number of lumens; a non-positive count removes nothing
+// Postcondition: the last count lumens are removed in one step; the capacity is kept
+void Nova::truncate(int count){
+    if (count > bank().size()) {
+        throw std::runtime_error("Cannot subtract more lumens than the Nova object contains.");
+    }
+    if (count <= 0) {
+        return;
+    }
+    ownBank().removeLast(count);
+}
+
+// Precondition: other must be a valid Nova object
+// Postcondition: other's lumens are appended to this Nova, like += other, and other holds no lumens;
+//                if this Nova has no lumens it takes other's bank without copying a lumen,
+//                otherwise other's lumens are copied and its bank is freed afterwards
+Nova& Nova::append(Nova&& other){
+    if (this == &other || other.bank().size() == 0) {
+        return *this;
+    }
+    if (bank().size() == 0) {
+        // Hand the bank over as is; copies still sharing it keep sharing it with this Nova
+        freeMemory();
+        lumens = other.lumens;
+        lumensPinned = other.lumensPinned;
+        other.lumens = nullptr;
+        other.lumensPinned = false;
+        return *this;
+    }
+    *this += other;
+    other.freeMemory();
+
+    return *this;
+}
+
+// Precondition: none
+// Postcondition: every lumen has been released at once; the Nova holds no lumens
+void Nova::releaseLumens(){
+    freeMemory();
+}
+
+// Precondition: 0 <= index < getNumLumens()
+// Postcondition: returns a handle to lumen 'index' that reads and updates it in place
+LumenRef Nova::lumen(int index){
+    if (index < 0 || index >= bank().size()) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    LumenRef ref(&ownBank(), index);
+    lumensPinned = true;
+    return ref;
 }
 
 /*
@@ -21,25 +21,56 @@ New Feature Added: Dependency Injection via Interface
 #define NOVA_H
 
 #include "lumen.h"
+#include "lumen_bank.h"
+#include "nova_metrics.h"
+
+template <class E> class NovaExpr;
+class NovaOperand;
+class WorkStealingPool;
 
 class ILuminosity{
     public:
     virtual ~ILuminosity() = default;
     virtual Lumen* illuminate(int brightness, int size, int power) = 0;
+    virtual void extinguish(Lumen* lumen){ // gives back a Lumen returned by illuminate
+        NovaMetrics::add(NovaCounter::LumenFrees);
+        delete lumen;
+    }
 };
 
 class Luminosity : public ILuminosity{
     public:
     Lumen* illuminate (int brightness, int size, int power) override{
-        return new Lumen(brightness, size, power);
+        Lumen* lumen = new Lumen(brightness, size, power);
+        NovaMetrics::add(NovaCounter::LumenAllocations);
+        return lumen;
     }
 };
 
-class Nova {
+// What every kind of Nova (the dynamic Nova, FixedNova<N>) can do, so code can drive either
+class INova{
+    public:
+    virtual ~INova() = default;
+    virtual void glow(int x) = 0;
+    virtual int minGlow() const = 0;
+    virtual int maxGlow() const = 0;
+    virtual int getNumLumens() const = 0;
+    virtual int getNumActiveLumens() const = 0;
+    virtual int getNumErraticLumens() const = 0;
+    virtual int getNumInactiveLumens() const = 0;
+    virtual int currentGlowValue(int index) const = 0;
+};
+
+class Nova : public INova {
 public:
     Nova(ILuminosity* luminate, int initialBrightness, int initialSize, int initialPower, int numLumens);
+    // Builds the lumens through a factory policy (lumen_factory.h) in one batch instead of one
+    // luminate->illuminate call per lumen; luminate still illuminates the lumens added later
+    template <class Factory>
+    Nova(ILuminosity* luminate, const Factory& factory, int initialBrightness, int initialSize,
+         int initialPower, int numLumens);
 
-    ~Nova();
+    ~Nova() override;
     Nova(const Nova& other);
     Nova(Nova&& other) noexcept;
     Nova& operator=(const Nova& other);
@@ -57,7 +88,7 @@ public:
 
     // Arithmetic operators
 
-    Nova operator+(const Nova& other) const; // standard
+    // Nova + Nova and Nova - Nova are lazy expressions, see nova_expr.h
     Nova operator+(int value) const; // mixed mode 
 
     Nova& operator+=(const Nova& other); // shortcut standard
@@ -67,7 +98,6 @@ public:
     Nova operator++(int); // postfix increment
 
 
-    Nova operator-(const Nova& other) const; // standard
     Nova operator-(int value) const; // mixed mode 
 
     Nova& operator-=(const Nova& other); // shortcut standard
@@ -77,38 +107,90 @@ public:
     Nova operator--(int); // postfix increment
 
 
-    void glow(int x);
-    int minGlow() const;
-    int maxGlow() const;
-    int getNumLumens();
+    void glow(int x) override;
+    void parallelGlow(WorkStealingPool* pool, int threshold); // glow(x) with x >= threshold splits [0, x) over pool
+    void glowTicks(int x, int ticks); // same state as ticks calls of glow(x), without simulating each tick
+    int minGlow() const override;
+    int maxGlow() const override;
+    std::vector<LumenGlow> topK(int k) const; // k brightest lumens, O(k log k) from the glow order; ties by index
+    std::vector<LumenGlow> bottomK(int k) const; // k dimmest lumens, O(k log k) from the glow order
+    GlowStats glowStats() const; // mean, histogram and approximate percentiles, in one pass
+    void addGlowStats(GlowStats& stats) const; // folds this Nova's glow values into stats, no new histogram
+    int glowPercentile(double q) const; // exact nearest-rank percentile, 0 <= q <= 1
+    int getNumLumens() const override;
+    int getNumActiveLumens() const override; // kept up to date by every change, O(1)
+    int getNumErraticLumens() const override;
+    int getNumInactiveLumens() const override;
+    int currentGlowValue(int index) const override; // read in place, unlike lumen(index)
+    // Indices of the lumens in each state, straight from the state index; no particular order
+    LumenIdRange activeLumens() const;
+    LumenIdRange erraticLumens() const;
+    LumenIdRange dimmedLumens() const;
+    LumenIdRange inactiveLumens() const; // erratic and dimmed
+
+    LumenRef lumen(int index); // per-element access into the lumen bank
+    void releaseLumens(); // drops every lumen of the Nova in one shot
+
+    // Capacity management; the storage grows geometrically on its own
+    int capacity() const;
+    void reserve(int numLumens);
+    void shrinkToFit();
+    void append(int count); // adds count default lumens, like count calls of ++
+    // += other, then other is empty: an O(m) copy of other's m lumens, O(1) only into an empty Nova
+    Nova& append(Nova&& other);
+    void truncate(int count); // removes the last count lumens, like count calls of --
 
 
 private:
+    template <class E> friend class NovaExpr; // materializes expressions into a new Nova
+    friend class NovaOperand; // reads the lumens of an operand in place
+    friend class NovaSnapshot; // saves and restores the lumen bank
+    friend class FleetImage; // writes the lumen bank into a fleet image
+    friend class NovaScheduler; // runs glow ticks as events on the lumen bank
+    template <int N> friend class FixedNova; // converts to and from the lumen bank
+    friend class LazyNova; // stores its touched lumens in a bank and converts to a Nova
+
     ILuminosity* luminate;
     
-    Lumen** lumens;
-    int numLumens;
+    // Copies share the bank until one of them changes it (copy-on-write). The bank also keeps
+    // its glow values in order, so minGlow/maxGlow are O(1) and every change costs O(log n).
+    struct SharedLumens;
+    SharedLumens* lumens;
+    bool lumensPinned; // a LumenRef may point into the bank, so copies must not share it
+
+    WorkStealingPool* glowPool; // nullptr: glow() always runs on the calling thread
+    int glowThreshold;
 
-    int maxGlowValue;
-    int minGlowValue;
+    explicit Nova(ILuminosity* luminate); // empty Nova, used to build operator results
 
+    void adoptLumen(Lumen* lumen);
+    void adoptBank(LumenBank&& bank);
     void copyLumens(const Nova& other);
     void moveLumens(Nova&& other) noexcept;
 
     void freeMemory();
 
+    const LumenBank& bank() const; // read access, never copies
+    LumenBank& ownBank(int extra = 0); // write access, clones a shared bank first
+
     void rechargeInactiveLumens();
 };
 
+#include "lumen_factory.h"
+#include "nova_expr.h"
+
 #endif
 
 
 /*
 Class Invariants for the Nova class:
 
-- The number of lumens (numLumens) must always be non-negative and should be positive.
-- The lumens pointer must always point to an array of Lumen pointers, or be nullptr if there are no lumens.
-- The individual Lumen objects within the lumens array must be properly initialized and have valid state, according to the Lumen class invariants.
+- The number of lumens (lumens.size()) must always be non-negative and should be positive.
+- lumens is either nullptr (no lumens) or a reference counted bank that may be shared with copies
+  of this Nova; a shared bank is never changed, every mutation goes through ownBank() and works on a private one.
+- A Nova that handed out a LumenRef never shares its bank, so the handle only ever sees this Nova.
+- glowPool, when set, outlives the Nova; parallel and sequential glows leave the same state behind.
+- The lumens bank holds one element per lumen; every element must have valid state, according to the Lumen class invariants.
 - The methods provided for managing and manipulating the Lumen objects (e.g., glow, reset_lumen) should maintain the invariants of the Lumen class and not introduce any inconsistencies in the state of the Lumen objects.
-- The Nova class must ensure proper memory management for the dynamically allocated Lumen objects, including correct use of copy/move constructors, assignment operators, and the destructor.
+- The Nova class must ensure proper memory management for the lumen bank and for the Lumen objects handed out by the ILuminosity factory, including correct use of copy/move constructors, assignment operators, and the destructor.
 */
\ No newline at end of file
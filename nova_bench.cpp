@@ -0,0 +1,509 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The benchmark driver measures the hot paths of the Lumen and Nova classes with Google Benchmark:
+Lumen::glow, Nova::glow for several x at every lumen count (also split over a thread pool, and
+run as events by a NovaScheduler), FixedNova glow and minGlow, minGlow/maxGlow (also alternating
+with glows that move the maximum inward), topK/bottomK, glowStats, construction through
+ILuminosity and through DirectLuminosity, the life of a small Nova, LazyNova construction and
+glow, the copy and move constructors, every arithmetic and resizing operator of Nova, and
+append(Nova&&). Lumen counts run from 5 to 10 million.
+
+Results are written as JSON unless another --benchmark_format is given, so two runs can be
+compared with Google Benchmark's compare.py, e.g.
+    ./nova_bench --benchmark_out=before.json
+    ./nova_bench --benchmark_filter=NovaGlow --benchmark_format=console
+
+ASSUMPTIONS:
+- The machine has enough memory for three Novas of 10 million lumens at once (the binary
+  operators need both operands and the result).
+- Operators that change the number of lumens are measured on a Nova that is put back to its
+  original size outside the timed region, so every iteration sees the same lumen count.
+*/
+
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "fixed_nova.h"
+#include "lazy_nova.h"
+#include "lumen.h"
+#include "nova.h"
+#include "nova_scheduler.h"
+#include "work_stealing_pool.h"
+
+namespace {
+
+const int BRIGHTNESS = 5;
+const int SIZE = 10;
+const int POWER = 20;
+const int STEADYPOWER = 1 << 30; // lumens with this much power stay active for the whole run
+const int BATCH = 1024; // ++ / -- run this many times between two restores of the lumen count
+const int TOPK = 10; // lumens listed by topK / bottomK
+
+Luminosity luminate;
+
+// Every lumen glows with 1 and stays active for the whole run, so the one lumen that glows
+// turns into the brightest by far once it is erratic
+class SteadyLuminosity : public ILuminosity {
+public:
+    Lumen* illuminate(int, int, int) override {
+        return new Lumen(1, 1, STEADYPOWER);
+    }
+};
+
+// Pre-Condition: b is a benchmark taking the lumen count as its first argument
+// Post-Condition: b runs for every lumen count from 5 to 10 million
+void lumenCounts(benchmark::internal::Benchmark* b) {
+    for (int n : {5, 50, 500, 5000, 50000, 500000, 5000000, 10000000}) {
+        b->Arg(n);
+    }
+}
+
+// Pre-Condition: b is a benchmark taking the lumen count and the percentage of lumens to glow
+// Post-Condition: b runs for every lumen count with 1%, 50% and 100% of the lumens glowing
+void glowShares(benchmark::internal::Benchmark* b) {
+    for (int n : {5, 50, 500, 5000, 50000, 500000, 5000000, 10000000}) {
+        for (int percent : {1, 50, 100}) {
+            b->Args({n, percent});
+        }
+    }
+}
+
+// Pre-Condition: n is positive
+// Post-Condition: returns how many lumens the resizing operators add or remove at lumen count n
+int resizeCount(int n) {
+    return std::max(1, n / 10);
+}
+
+// Pre-Condition: n is positive
+// Post-Condition: returns a Nova with n lumens built through the default factory
+Nova makeNova(int n) {
+    return Nova(&luminate, BRIGHTNESS, SIZE, POWER, n);
+}
+
+/************************************** Lumen *****************************************************/
+
+void BM_LumenGlow(benchmark::State& state) {
+    Lumen lumen(BRIGHTNESS, SIZE, POWER);
+    int glows = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lumen.glow());
+        if (++glows == BATCH) {
+            lumen.recharge(); // keeps power from running off to INT_MIN
+            glows = 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LumenGlow);
+
+/************************************** Nova Core Functions ***************************************/
+
+void BM_NovaGlow(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    int x = std::max(1, static_cast<int>(static_cast<long long>(n) * state.range(1) / 100));
+    Nova nova = makeNova(n);
+    for (auto _ : state) {
+        nova.glow(x);
+    }
+    state.SetItemsProcessed(state.iterations() * x);
+}
+BENCHMARK(BM_NovaGlow)->Apply(glowShares)->Unit(benchmark::kMicrosecond);
+
+// glow of every lumen, split over every hardware thread
+void BM_NovaGlowParallel(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    WorkStealingPool pool;
+    Nova nova = makeNova(n);
+    nova.parallelGlow(&pool, 0);
+    for (auto _ : state) {
+        nova.glow(n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaGlowParallel)->Arg(500000)->Arg(5000000)->Arg(10000000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// glow of every lumen while all of them stay active, one glow(n) call per tick
+void BM_NovaGlowSteady(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova nova(&luminate, BRIGHTNESS, SIZE, STEADYPOWER, n);
+    for (auto _ : state) {
+        nova.glow(n);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaGlowSteady)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// glow of every lumen of a FixedNova, to set against BM_NovaGlow/N/100
+template <int N>
+void BM_FixedNovaGlow(benchmark::State& state) {
+    FixedNova<N> nova(BRIGHTNESS, SIZE, POWER);
+    for (auto _ : state) {
+        nova.glow(N);
+    }
+    state.SetItemsProcessed(state.iterations() * N);
+}
+BENCHMARK_TEMPLATE(BM_FixedNovaGlow, 5);
+BENCHMARK_TEMPLATE(BM_FixedNovaGlow, 8);
+BENCHMARK_TEMPLATE(BM_FixedNovaGlow, 64);
+
+// the same ticks run as events by a NovaScheduler
+void BM_NovaScheduledGlow(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova nova(&luminate, BRIGHTNESS, SIZE, STEADYPOWER, n);
+    NovaScheduler scheduler(nova, n);
+    for (auto _ : state) {
+        scheduler.tick();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaScheduledGlow)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaMinGlow(benchmark::State& state) {
+    Nova nova = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nova.minGlow());
+    }
+}
+BENCHMARK(BM_NovaMinGlow)->Apply(lumenCounts);
+
+void BM_NovaMaxGlow(benchmark::State& state) {
+    Nova nova = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nova.maxGlow());
+    }
+}
+BENCHMARK(BM_NovaMaxGlow)->Apply(lumenCounts);
+
+// glow(1) and the min/max a dashboard polls after it, while the brightest lumen is the erratic
+// one that glows: its value drops on every glow, so the maximum moves inward every iteration
+void BM_NovaGlowMinMax(benchmark::State& state) {
+    SteadyLuminosity steady;
+    Nova nova(&steady, 1, 1, 1, static_cast<int>(state.range(0)));
+    int threshold = static_cast<int>(STEADYPOWER * (20.0 / 100));
+    nova.glowTicks(1, STEADYPOWER - threshold); // lumen 0 is erratic from here on
+    for (auto _ : state) {
+        nova.glow(1);
+        benchmark::DoNotOptimize(nova.minGlow());
+        benchmark::DoNotOptimize(nova.maxGlow());
+    }
+}
+BENCHMARK(BM_NovaGlowMinMax)->Apply(lumenCounts);
+
+template <int N>
+void BM_FixedNovaMinGlow(benchmark::State& state) {
+    FixedNova<N> nova(BRIGHTNESS, SIZE, POWER);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nova.minGlow());
+    }
+}
+BENCHMARK_TEMPLATE(BM_FixedNovaMinGlow, 5);
+BENCHMARK_TEMPLATE(BM_FixedNovaMinGlow, 64);
+
+void BM_NovaTopK(benchmark::State& state) {
+    Nova nova = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nova.topK(TOPK));
+    }
+}
+BENCHMARK(BM_NovaTopK)->Apply(lumenCounts);
+
+void BM_NovaBottomK(benchmark::State& state) {
+    Nova nova = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(nova.bottomK(TOPK));
+    }
+}
+BENCHMARK(BM_NovaBottomK)->Apply(lumenCounts);
+
+void BM_NovaGlowStats(benchmark::State& state) {
+    Nova nova = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        GlowStats stats = nova.glowStats();
+        benchmark::DoNotOptimize(stats.p99());
+    }
+}
+BENCHMARK(BM_NovaGlowStats)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+/************************************** Construction **********************************************/
+
+// one luminate->illuminate call (and one heap Lumen) per lumen
+void BM_NovaConstruct(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Nova nova(&luminate, BRIGHTNESS, SIZE, POWER, n);
+        benchmark::DoNotOptimize(&nova);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaConstruct)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// every lumen built in place by the DirectLuminosity policy
+void BM_NovaConstructDirect(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Nova nova(&luminate, DirectLuminosity(), BRIGHTNESS, SIZE, POWER, n);
+        benchmark::DoNotOptimize(&nova);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaConstructDirect)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// a LazyNova built, glowed over its first few lumens and asked for minGlow; only those are stored
+void BM_LazyNovaConstructGlow(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        LazyNova nova(BRIGHTNESS, SIZE, POWER, n);
+        nova.glow(std::min(n, 5));
+        benchmark::DoNotOptimize(nova.minGlow());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_LazyNovaConstructGlow)->Apply(lumenCounts);
+
+// a small Nova built, glowed, grown by one lumen and read, as a fleet of tiny Novas does;
+// up to 16 lumens the columns stay inline in the bank, the 17th moves them to the heap
+void BM_SmallNovaLifecycle(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Nova nova(&luminate, DirectLuminosity(), BRIGHTNESS, SIZE, POWER, n);
+        nova.glow(n);
+        ++nova;
+        benchmark::DoNotOptimize(nova.minGlow());
+    }
+}
+BENCHMARK(BM_SmallNovaLifecycle)->Arg(1)->Arg(5)->Arg(8)->Arg(15)->Arg(16);
+
+/************************************** Copy / Move ***********************************************/
+
+void BM_NovaCopyConstruct(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova source = makeNova(n);
+    for (auto _ : state) {
+        Nova copy(source);
+        benchmark::DoNotOptimize(&copy);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaCopyConstruct)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// Moves the Nova out with the move constructor and back with move assignment
+void BM_NovaMoveConstruct(benchmark::State& state) {
+    Nova source = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        Nova moved(std::move(source));
+        benchmark::DoNotOptimize(&moved);
+        source = std::move(moved);
+    }
+}
+BENCHMARK(BM_NovaMoveConstruct)->Apply(lumenCounts);
+
+/************************************** Arithmetic Operators **************************************/
+
+void BM_NovaAddNova(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n);
+    Nova b = makeNova(n);
+    for (auto _ : state) {
+        Nova sum = a + b;
+        benchmark::DoNotOptimize(&sum);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaAddNova)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// a + b - c is fused into one pass, only the final Nova is built
+void BM_NovaAddSubChain(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n);
+    Nova b = makeNova(n);
+    Nova c = makeNova(n);
+    for (auto _ : state) {
+        Nova result = a + b - c;
+        benchmark::DoNotOptimize(&result);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaAddSubChain)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaAddInt(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n);
+    for (auto _ : state) {
+        Nova grown = a + resizeCount(n);
+        benchmark::DoNotOptimize(&grown);
+    }
+}
+BENCHMARK(BM_NovaAddInt)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaAddAssignNova(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n);
+    Nova b = makeNova(resizeCount(n));
+    for (auto _ : state) {
+        a += b;
+        state.PauseTiming();
+        a.truncate(b.getNumLumens());
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaAddAssignNova)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+// the lumens of one Nova moved into an empty one and back; the bank changes hands, no lumen is copied
+void BM_NovaAppendMoved(benchmark::State& state) {
+    Nova a = makeNova(static_cast<int>(state.range(0)));
+    Nova b(&luminate, BRIGHTNESS, SIZE, POWER, 1);
+    b.releaseLumens();
+    for (auto _ : state) {
+        b.append(std::move(a));
+        a.append(std::move(b));
+        benchmark::DoNotOptimize(&a);
+    }
+}
+BENCHMARK(BM_NovaAppendMoved)->Apply(lumenCounts);
+
+void BM_NovaAddAssignInt(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    int k = resizeCount(n);
+    Nova a = makeNova(n);
+    for (auto _ : state) {
+        a += k;
+        state.PauseTiming();
+        a.truncate(k);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaAddAssignInt)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaPreIncrement(benchmark::State& state) {
+    Nova a = makeNova(static_cast<int>(state.range(0)));
+    int added = 0;
+    for (auto _ : state) {
+        ++a;
+        if (++added == BATCH) {
+            state.PauseTiming();
+            a.truncate(added);
+            added = 0;
+            state.ResumeTiming();
+        }
+    }
+}
+BENCHMARK(BM_NovaPreIncrement)->Apply(lumenCounts);
+
+void BM_NovaPostIncrement(benchmark::State& state) {
+    Nova a = makeNova(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        Nova before = a++;
+        benchmark::DoNotOptimize(&before);
+        state.PauseTiming();
+        a.truncate(1);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaPostIncrement)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaSubNova(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n);
+    Nova b = makeNova(n);
+    for (auto _ : state) {
+        Nova difference = a - b;
+        benchmark::DoNotOptimize(&difference);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_NovaSubNova)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaSubInt(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    Nova a = makeNova(n + resizeCount(n));
+    for (auto _ : state) {
+        Nova shrunk = a - resizeCount(n);
+        benchmark::DoNotOptimize(&shrunk);
+    }
+}
+BENCHMARK(BM_NovaSubInt)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaSubAssignNova(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    int k = resizeCount(n);
+    Nova a = makeNova(n + k);
+    Nova b = makeNova(k);
+    for (auto _ : state) {
+        a -= b;
+        state.PauseTiming();
+        a.append(k);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaSubAssignNova)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaSubAssignInt(benchmark::State& state) {
+    int n = static_cast<int>(state.range(0));
+    int k = resizeCount(n);
+    Nova a = makeNova(n + k);
+    for (auto _ : state) {
+        a -= k;
+        state.PauseTiming();
+        a.append(k);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaSubAssignInt)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+void BM_NovaPreDecrement(benchmark::State& state) {
+    Nova a = makeNova(static_cast<int>(state.range(0)) + BATCH);
+    int removed = 0;
+    for (auto _ : state) {
+        --a;
+        if (++removed == BATCH) {
+            state.PauseTiming();
+            a.append(removed);
+            removed = 0;
+            state.ResumeTiming();
+        }
+    }
+}
+BENCHMARK(BM_NovaPreDecrement)->Apply(lumenCounts);
+
+void BM_NovaPostDecrement(benchmark::State& state) {
+    Nova a = makeNova(static_cast<int>(state.range(0)) + 1);
+    for (auto _ : state) {
+        Nova before = a--;
+        benchmark::DoNotOptimize(&before);
+        state.PauseTiming();
+        a.append(1);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_NovaPostDecrement)->Apply(lumenCounts)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+
+// Pre-Condition: argv holds Google Benchmark flags
+// Post-Condition: runs the selected benchmarks, reporting JSON unless a format was given
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    static char jsonFormat[] = "--benchmark_format=json";
+    bool formatGiven = std::any_of(args.begin(), args.end(), [](const char* arg) {
+        return std::strncmp(arg, "--benchmark_format", 18) == 0;
+    });
+    if (!formatGiven) {
+        args.insert(args.begin() + 1, jsonFormat);
+    }
+
+    int count = static_cast<int>(args.size());
+    benchmark::Initialize(&count, args.data());
+    if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
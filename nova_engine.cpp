@@ -0,0 +1,105 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The NovaEngine class drives a fleet of Novas in parallel. A glow tick or a min/max query is one
+parallelFor over the fleet, and results are written into the slot of their Nova, so the output
+is the same for any number of threads. Glow statistics are gathered per group of Novas and the
+group results merged afterwards.
+
+ASSUMPTIONS:
+- No other thread modifies the fleet while an engine call is running.
+- lumensToGlow is valid for every Nova in the fleet; otherwise the Nova::glow error of the
+  first offending Nova (in fleet order) is rethrown after the tick.
+*/
+
+#include "nova_engine.h"
+#include <algorithm>
+
+namespace {
+constexpr int STATSGROUPSPERTHREAD = 4; // groups of Novas per thread in glowStats, for stealing
+}
+
+// Pre-Condition: fleet outlives the engine; numThreads is non-negative (0 = every hardware thread)
+// Post-Condition: an engine working on fleet with numThreads threads is created
+NovaEngine::NovaEngine(std::vector<std::unique_ptr<Nova>>& fleet, int numThreads)
+: fleet(fleet), pool(numThreads) {}
+
+// Pre-Condition: lumensToGlow is valid for every Nova in the fleet
+// Post-Condition: every Nova in the fleet has glowed once
+void NovaEngine::glow(int lumensToGlow) {
+    glow(lumensToGlow, 1);
+}
+
+// Pre-Condition: lumensToGlow is valid for every Nova in the fleet; ticks is non-negative
+// Post-Condition: every Nova in the fleet has glowed ticks times
+void NovaEngine::glow(int lumensToGlow, int ticks) {
+    pool.parallelFor(static_cast<int>(fleet.size()), [this, lumensToGlow, ticks](int i) {
+        Nova* nova = fleet[i].get();
+        if (!nova) {
+            return;
+        }
+        // a single tick takes glow()'s kernel path (and the Nova's parallelGlow setting) directly
+        if (ticks == 1) {
+            nova->glow(lumensToGlow);
+        } else {
+            nova->glowTicks(lumensToGlow, ticks);
+        }
+    });
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the min and max glow value of every Nova, in fleet order
+std::vector<NovaGlowRange> NovaEngine::glowRanges() const {
+    std::vector<NovaGlowRange> ranges(fleet.size(), NovaGlowRange{false, 0, 0});
+    pool.parallelFor(static_cast<int>(fleet.size()), [this, &ranges](int i) {
+        Nova* nova = fleet[i].get();
+        if (!nova || nova->getNumLumens() == 0) {
+            return;
+        }
+        ranges[i] = NovaGlowRange{true, nova->minGlow(), nova->maxGlow()};
+    });
+    return ranges;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the merged glow statistics of every lumen in the fleet
+GlowStats NovaEngine::glowStats() const {
+    // one GlowStats per group of Novas, filled by every Nova of the group in turn, so no Nova
+    // builds a histogram of its own and only the groups are merged
+    int numNovas = static_cast<int>(fleet.size());
+    int numGroups = std::min(numNovas, pool.getNumThreads() * STATSGROUPSPERTHREAD);
+    std::vector<GlowStats> groups(numGroups);
+    pool.parallelFor(numGroups, [this, numNovas, numGroups, &groups](int g) {
+        int first = static_cast<int>(static_cast<long long>(numNovas) * g / numGroups);
+        int last = static_cast<int>(static_cast<long long>(numNovas) * (g + 1) / numGroups);
+        for (int i = first; i < last; i++) {
+            if (fleet[i]) {
+                fleet[i]->addGlowStats(groups[g]);
+            }
+        }
+    });
+
+    GlowStats stats;
+    for (const GlowStats& group : groups) {
+        stats.merge(group);
+    }
+    return stats;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of threads the engine runs on
+int NovaEngine::getNumThreads() const {
+    return pool.getNumThreads();
+}
+
+
+/*
+Implementation Invariant:
+- Each task only reads and writes fleet[i] and ranges[i] for its own i; a glowStats task only
+  reads its own group of Novas and writes groups[g].
+- Merging GlowStats is order-independent, so the merged statistics do not depend on the grouping.
+*/
@@ -0,0 +1,55 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaEngine.h is the header file for the NovaEngine class, which runs glow ticks, min/max glow
+queries and glow statistics over a whole fleet of Novas on every core. Each Nova is
+independent, so every Nova becomes one task of a WorkStealingPool; Novas of very different sizes
+are balanced by stealing instead of by a fixed split of the fleet.
+*/
+
+#ifndef NOVA_ENGINE_H
+#define NOVA_ENGINE_H
+
+#include <memory>
+#include <vector>
+#include "nova.h"
+#include "work_stealing_pool.h"
+
+struct NovaGlowRange {
+    bool valid; // false for an empty slot or a Nova without lumens
+    int minGlow;
+    int maxGlow;
+};
+
+class NovaEngine {
+public:
+    explicit NovaEngine(std::vector<std::unique_ptr<Nova>>& fleet, int numThreads = 0);
+
+    void glow(int lumensToGlow); // one glow tick on every Nova
+    void glow(int lumensToGlow, int ticks); // ticks consecutive glow ticks on every Nova
+
+    std::vector<NovaGlowRange> glowRanges() const; // min and max glow of every Nova, in fleet order
+    GlowStats glowStats() const; // glow statistics of every lumen of the fleet, merged
+
+    int getNumThreads() const;
+
+private:
+    std::vector<std::unique_ptr<Nova>>& fleet;
+    mutable WorkStealingPool pool;
+};
+
+#endif // NOVA_ENGINE_H
+
+
+/*
+Class invariants for NovaEngine:
+
+- fleet refers to the vector passed at construction, which must outlive the engine; empty
+  (nullptr) slots are skipped.
+- Every Nova is only ever touched by one task at a time, and each task runs the same sequential
+  Nova calls as a single-threaded loop would, so results do not depend on the thread count.
+*/
@@ -0,0 +1,313 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaExpr.h holds the expression templates behind Nova + Nova and Nova - Nova. Instead of
+building a whole Nova for every operator, a + b - c builds a small tree of expression nodes
+that only refer to a, b and c. The tree becomes a Nova when it is assigned to or converted to
+one; every lumen of the result is then computed in a single elementwise pass over the operands,
+and only the final lumens are illuminated. An expression still compares and answers queries like
+the Nova it stands for, so (a + b) == c and (a + b).minGlow() work as they did when + was eager.
+
+Each node yields, per lumen index, the brightness, size and power the eager operator would
+have illuminated at that index, and throws the same exceptions:
+- a + b: std::invalid_argument when the lumen counts differ, and std::out_of_range when a sum
+  is not positive (the Lumen constructor's rule).
+- a - b: std::out_of_range when the lumen counts differ; non-positive differences become 1.
+
+ASSUMPTIONS:
+- Expressions refer to their Nova operands. They are meant to be turned into a Nova within the
+  same full expression (Nova sum = a + b - c;) and must not be kept in an auto variable beyond
+  the lifetime of the operands.
+- The factory of the result is the factory of the leftmost operand, as with the eager operators.
+- Factories build the Lumen they are asked for, so an intermediate result would only have
+  passed its brightness, size and power on to the next operator.
+*/
+
+#ifndef NOVA_EXPR_H
+#define NOVA_EXPR_H
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "nova.h"
+#include "lumen_factory.h"
+
+struct NovaExprTag {}; // marks expression nodes for the operator templates
+
+template <class E>
+class NovaExpr : public NovaExprTag {
+public:
+    operator Nova() const; // materializes the expression in one pass
+
+    // The queries of a Nova; each one but getNumLumens materializes the expression first, so
+    // convert it to a Nova once to ask several
+    int minGlow() const;
+    int maxGlow() const;
+    int getNumLumens() const;
+    int getNumActiveLumens() const;
+    int getNumErraticLumens() const;
+    int getNumInactiveLumens() const;
+    int currentGlowValue(int index) const;
+
+private:
+    const E& derived() const { return static_cast<const E&>(*this); }
+};
+
+// Leaf of an expression: reads the lumens of a Nova in place
+class NovaOperand : public NovaExpr<NovaOperand> {
+public:
+    explicit NovaOperand(const Nova& nova) : nova(nova) {}
+
+    int size() const { return nova.bank().size(); }
+    ILuminosity* factory() const { return nova.luminate; }
+    LumenValues at(int index) const {
+        const LumenBank& lumens = nova.bank();
+        return LumenValues{lumens.getBrightness(index), lumens.getSize(index), lumens.getPower(index)};
+    }
+
+private:
+    const Nova& nova;
+};
+
+template <class L, class R>
+class NovaSum : public NovaExpr<NovaSum<L, R>> {
+public:
+    // Pre-Condition: both operands have the same number of lumens
+    // Post-Condition: a lazy left + right is created
+    NovaSum(const L& left, const R& right) : left(left), right(right) {
+        if (left.size() != right.size()) {
+            throw std::invalid_argument("Nova objects must have the same number of lumens to be added together.");
+        }
+    }
+
+    int size() const { return left.size(); }
+    ILuminosity* factory() const { return left.factory(); }
+
+    // Pre-Condition: 0 <= index < size()
+    // Post-Condition: returns the summed lumen values; throws if any of them is not positive
+    LumenValues at(int index) const {
+        LumenValues a = left.at(index);
+        LumenValues b = right.at(index);
+        LumenValues sum{a.brightness + b.brightness, a.size + b.size, a.power + b.power};
+        if (sum.brightness <= 0 || sum.size <= 0 || sum.power <= 0) {
+            throw std::out_of_range("All input values for Lumen must be positive.");
+        }
+        return sum;
+    }
+
+private:
+    L left;
+    R right;
+};
+
+template <class L, class R>
+class NovaDifference : public NovaExpr<NovaDifference<L, R>> {
+public:
+    // Pre-Condition: both operands have the same number of lumens
+    // Post-Condition: a lazy left - right is created
+    NovaDifference(const L& left, const R& right) : left(left), right(right) {
+        if (left.size() != right.size()) {
+            throw std::out_of_range("Cannot subtract Novas with different numbers of Lumens.");
+        }
+    }
+
+    int size() const { return left.size(); }
+    ILuminosity* factory() const { return left.factory(); }
+
+    // Pre-Condition: 0 <= index < size()
+    // Post-Condition: returns the lumen value differences, non-positive ones raised to 1
+    LumenValues at(int index) const {
+        LumenValues a = left.at(index);
+        LumenValues b = right.at(index);
+        LumenValues difference{a.brightness - b.brightness, a.size - b.size, a.power - b.power};
+        if (difference.brightness <= 0) difference.brightness = 1;
+        if (difference.size <= 0) difference.size = 1;
+        if (difference.power <= 0) difference.power = 1;
+        return difference;
+    }
+
+private:
+    L left;
+    R right;
+};
+
+// Pre-Condition: the operands of the expression are alive
+// Post-Condition: returns a new Nova whose lumens are illuminated from the expression values
+template <class E>
+NovaExpr<E>::operator Nova() const {
+    const E& expr = derived();
+    Nova result(expr.factory());
+    result.adoptBank(LuminosityAdapter(expr.factory()).illuminateBatch(expr.size(), [&expr](int i) {
+        return expr.at(i);
+    }));
+    return result;
+}
+
+// Pre-Condition: the operands of the expression are alive and it has lumens
+// Post-Condition: returns the smallest glow value of the materialized expression
+template <class E>
+int NovaExpr<E>::minGlow() const {
+    return Nova(*this).minGlow();
+}
+
+// Pre-Condition: the operands of the expression are alive and it has lumens
+// Post-Condition: returns the largest glow value of the materialized expression
+template <class E>
+int NovaExpr<E>::maxGlow() const {
+    return Nova(*this).maxGlow();
+}
+
+// Pre-Condition: the operands of the expression are alive
+// Post-Condition: returns the number of lumens of the expression, without materializing it
+template <class E>
+int NovaExpr<E>::getNumLumens() const {
+    return derived().size();
+}
+
+// Pre-Condition: the operands of the expression are alive
+// Post-Condition: returns the number of active lumens of the materialized expression
+template <class E>
+int NovaExpr<E>::getNumActiveLumens() const {
+    return Nova(*this).getNumActiveLumens();
+}
+
+// Pre-Condition: the operands of the expression are alive
+// Post-Condition: returns the number of erratic lumens of the materialized expression
+template <class E>
+int NovaExpr<E>::getNumErraticLumens() const {
+    return Nova(*this).getNumErraticLumens();
+}
+
+// Pre-Condition: the operands of the expression are alive
+// Post-Condition: returns the number of inactive lumens of the materialized expression
+template <class E>
+int NovaExpr<E>::getNumInactiveLumens() const {
+    return Nova(*this).getNumInactiveLumens();
+}
+
+// Pre-Condition: the operands of the expression are alive; 0 <= index < getNumLumens()
+// Post-Condition: returns the glow value of lumen index of the materialized expression
+template <class E>
+int NovaExpr<E>::currentGlowValue(int index) const {
+    return Nova(*this).currentGlowValue(index);
+}
+
+/************************************ Operators ***************************************************/
+
+inline NovaOperand asNovaExpr(const Nova& nova) {
+    return NovaOperand(nova);
+}
+
+template <class E>
+const E& asNovaExpr(const NovaExpr<E>& expr) {
+    return static_cast<const E&>(expr);
+}
+
+template <class T>
+constexpr bool isNovaTerm = std::is_same<T, Nova>::value || std::is_base_of<NovaExprTag, T>::value;
+
+template <class T>
+using NovaExprType = std::decay_t<decltype(asNovaExpr(std::declval<const T&>()))>;
+
+// A comparison with an expression on either side; Nova == Nova stays the member operator
+template <class L, class R>
+using NovaExprComparison = std::enable_if_t<isNovaTerm<L> && isNovaTerm<R>
+    && (std::is_base_of<NovaExprTag, L>::value || std::is_base_of<NovaExprTag, R>::value), bool>;
+
+inline const Nova& asNova(const Nova& nova) {
+    return nova;
+}
+
+template <class E>
+Nova asNova(const NovaExpr<E>& expr) {
+    return expr;
+}
+
+// Precondition: left and right have the same number of lumens
+// Postcondition: returns the lazy sum of left and right
+template <class L, class R, class = std::enable_if_t<isNovaTerm<L> && isNovaTerm<R>>>
+NovaSum<NovaExprType<L>, NovaExprType<R>> operator+(const L& left, const R& right) {
+    return NovaSum<NovaExprType<L>, NovaExprType<R>>(asNovaExpr(left), asNovaExpr(right));
+} // standard
+
+// Precondition: left and right have the same number of lumens
+// Postcondition: returns the lazy difference of left and right
+template <class L, class R, class = std::enable_if_t<isNovaTerm<L> && isNovaTerm<R>>>
+NovaDifference<NovaExprType<L>, NovaExprType<R>> operator-(const L& left, const R& right) {
+    return NovaDifference<NovaExprType<L>, NovaExprType<R>>(asNovaExpr(left), asNovaExpr(right));
+} // standard
+
+// Precondition: the operands of expr are alive
+// Postcondition: returns expr as a Nova with value default lumens added
+template <class E>
+Nova operator+(const NovaExpr<E>& expr, int value) {
+    return Nova(expr) + value;
+} // mixed mode
+
+// Precondition: value is less than the number of lumens of expr
+// Postcondition: returns expr as a Nova with value lumens removed
+template <class E>
+Nova operator-(const NovaExpr<E>& expr, int value) {
+    return Nova(expr) - value;
+} // mixed mode
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if both sides, materialized, hold the same lumens
+template <class L, class R>
+NovaExprComparison<L, R> operator==(const L& left, const R& right) {
+    return asNova(left) == asNova(right);
+}
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if both sides, materialized, do not hold the same lumens
+template <class L, class R>
+NovaExprComparison<L, R> operator!=(const L& left, const R& right) {
+    return !(left == right);
+}
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if left has fewer lumens than right; nothing is materialized
+template <class L, class R>
+NovaExprComparison<L, R> operator<(const L& left, const R& right) {
+    return asNovaExpr(left).size() < asNovaExpr(right).size();
+}
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if left has more lumens than right; nothing is materialized
+template <class L, class R>
+NovaExprComparison<L, R> operator>(const L& left, const R& right) {
+    return asNovaExpr(left).size() > asNovaExpr(right).size();
+}
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if left has at most as many lumens as right; nothing is materialized
+template <class L, class R>
+NovaExprComparison<L, R> operator<=(const L& left, const R& right) {
+    return !(left > right);
+}
+
+// Precondition: the operands of every expression are alive
+// Postcondition: returns true if left has at least as many lumens as right; nothing is materialized
+template <class L, class R>
+NovaExprComparison<L, R> operator>=(const L& left, const R& right) {
+    return !(left < right);
+}
+
+#endif // NOVA_EXPR_H
+
+
+/*
+Class invariants for the Nova expressions:
+
+- An expression node holds its sub-expressions by value and its Nova operands by reference;
+  nothing is computed or allocated until the expression is converted to a Nova.
+- All operands of a node have the same number of lumens, checked when the node is built.
+- at(i) of a node equals the brightness, size and power of lumen i of the Nova the eager
+  operator would have built, and throws wherever the eager operator would have thrown.
+- Every comparison and query of an expression answers what it would answer on the Nova the
+  expression converts to.
+*/
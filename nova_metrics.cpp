@@ -0,0 +1,184 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The NovaMetrics class keeps a registry of the counter blocks of all live threads. A thread
+registers its block the first time it counts; when the thread exits its totals are folded into
+the registry and the block is dropped. Readers sum the registry and the live blocks under the
+registry lock. reset() does not touch the blocks (other threads may be writing them), it only
+records the current totals as the new zero.
+
+ASSUMPTIONS:
+- Nothing counts from a thread_local destructor that runs after the thread's own block was
+  destroyed.
+*/
+
+#include "nova_metrics.h"
+#include <algorithm>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+struct CounterInfo {
+    const char* name;
+    const char* help;
+};
+
+const CounterInfo COUNTERS[NUMNOVACOUNTERS] = {
+    {"nova_glows", "Ticks of Nova::glow."},
+    {"nova_lumen_glows", "Individual lumen glows done by Nova and LumenBank."},
+    {"nova_active_to_erratic", "Lumens that went from active to erratic."},
+    {"nova_active_to_dimmed", "Lumens that went from active straight to dimmed."},
+    {"nova_erratic_to_dimmed", "Lumens that went from erratic to dimmed."},
+    {"nova_reactivated", "Erratic or dimmed lumens that became active again."},
+    {"nova_reset_successes", "Lumen resets that restored the original brightness and power."},
+    {"nova_reset_failures", "Lumen resets that only dimmed the lumen or were refused."},
+    {"nova_resets_exhausted", "Lumen resets refused because maxReset was reached."},
+    {"nova_recharge_rounds", "Recharges triggered by rechargeInactiveLumens."},
+    {"nova_lumen_allocations", "Lumens built by the Luminosity and PooledLuminosity factories."},
+    {"nova_lumen_frees", "Lumens given back through ILuminosity::extinguish."}
+};
+
+struct Registry {
+    std::mutex lock;
+    std::vector<NovaMetrics::ThreadCounters*> live;
+    std::uint64_t retired[NUMNOVACOUNTERS] = {}; // totals of threads that have exited
+    std::uint64_t baseline[NUMNOVACOUNTERS] = {}; // totals at the last reset()
+};
+
+// Never destroyed, so threads that exit during static destruction can still retire their block
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+} // namespace
+
+// The block of one thread; it retires itself when the thread exits
+struct NovaMetrics::ThreadSlot {
+    ThreadCounters counters;
+
+    ThreadSlot() {
+        for (std::atomic<std::uint64_t>& value : counters.values) {
+            value.store(0, std::memory_order_relaxed);
+        }
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        reg.live.push_back(&counters);
+    }
+
+    ~ThreadSlot();
+};
+
+// Pre-Condition: None
+// Post-Condition: returns the calling thread's counter block, registering it on first use
+NovaMetrics::ThreadCounters* NovaMetrics::registerThread() {
+    thread_local ThreadSlot slot;
+    local = &slot.counters;
+    return local;
+}
+
+// Pre-Condition: the owning thread is exiting
+// Post-Condition: the block's totals are kept by the registry and the block is unregistered
+NovaMetrics::ThreadSlot::~ThreadSlot() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+        reg.retired[c] += counters.values[c].load(std::memory_order_relaxed);
+    }
+    reg.live.erase(std::find(reg.live.begin(), reg.live.end(), &counters));
+    local = nullptr;
+}
+
+// Pre-Condition: values holds NUMNOVACOUNTERS entries
+// Post-Condition: values receives every counter, summed over all threads, since the last reset
+void NovaMetrics::snapshot(std::uint64_t* values) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+        std::uint64_t total = reg.retired[c];
+        for (ThreadCounters* counters : reg.live) {
+            total += counters->values[c].load(std::memory_order_relaxed);
+        }
+        values[c] = total - reg.baseline[c];
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns counter summed over all threads since the last reset
+std::uint64_t NovaMetrics::value(NovaCounter counter) {
+    std::uint64_t values[NUMNOVACOUNTERS];
+    snapshot(values);
+    return values[static_cast<int>(counter)];
+}
+
+// Pre-Condition: None
+// Post-Condition: every counter reads 0 until new events are counted
+void NovaMetrics::reset() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+        std::uint64_t total = reg.retired[c];
+        for (ThreadCounters* counters : reg.live) {
+            total += counters->values[c].load(std::memory_order_relaxed);
+        }
+        reg.baseline[c] = total;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns false if the counters were compiled out
+bool NovaMetrics::enabled() {
+#ifndef NOVA_DISABLE_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the exported name of counter
+const char* NovaMetrics::name(NovaCounter counter) {
+    return COUNTERS[static_cast<int>(counter)].name;
+}
+
+// Pre-Condition: None
+// Post-Condition: returns every counter in the Prometheus text exposition format
+std::string NovaMetrics::prometheus() {
+    std::uint64_t values[NUMNOVACOUNTERS];
+    snapshot(values);
+    std::ostringstream out;
+    for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+        out << "# HELP " << COUNTERS[c].name << "_total " << COUNTERS[c].help << "\n"
+            << "# TYPE " << COUNTERS[c].name << "_total counter\n"
+            << COUNTERS[c].name << "_total " << values[c] << "\n";
+    }
+    return out.str();
+}
+
+// Pre-Condition: None
+// Post-Condition: returns every counter as one JSON object
+std::string NovaMetrics::json() {
+    std::uint64_t values[NUMNOVACOUNTERS];
+    snapshot(values);
+    std::ostringstream out;
+    out << "{";
+    for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+        out << (c ? ", " : "") << "\"" << COUNTERS[c].name << "\": " << values[c];
+    }
+    out << "}";
+    return out.str();
+}
+
+
+/*
+Implementation Invariant:
+- registry().live holds exactly the blocks of the threads that have counted and not exited.
+- Every event counted by an exited thread is in registry().retired.
+- baseline never exceeds the running totals, so the unsigned differences never wrap.
+*/
@@ -0,0 +1,91 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaMetrics.h declares the built-in event counters of the Lumen and Nova classes: glow calls,
+lumen state transitions, reset outcomes, recharge rounds and Lumen allocations. Every thread
+counts into its own cache-line aligned block with plain relaxed stores, so counting never
+contends; the blocks are only summed when the counters are read or exported as Prometheus text
+or JSON.
+
+Building with NOVA_DISABLE_METRICS defined (CMake option NOVA_METRICS=OFF) turns add() into an
+empty inline function, so the counters cost nothing; the readers and exporters then report 0.
+*/
+
+#ifndef NOVA_METRICS_H
+#define NOVA_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+enum class NovaCounter : int {
+    NovaGlows = 0, // ticks of Nova::glow (a glowTicks call counts each tick)
+    LumenGlows, // individual lumen glows done by Nova and LumenBank
+    ActiveToErratic, // lumen state transitions
+    ActiveToDimmed,
+    ErraticToDimmed,
+    Reactivated, // an erratic or dimmed lumen became active again (reset or recharge)
+    ResetSuccesses,
+    ResetFailures, // including resets refused because maxReset was reached
+    ResetsExhausted, // resets refused because maxReset was reached
+    RechargeRounds, // recharges triggered by rechargeInactiveLumens
+    LumenAllocations, // Lumens built by the Luminosity and PooledLuminosity factories
+    LumenFrees // Lumens given back through ILuminosity::extinguish
+};
+
+constexpr int NUMNOVACOUNTERS = 12;
+
+class NovaMetrics {
+public:
+    static void add(NovaCounter counter, std::uint64_t n = 1); // counts on the calling thread
+
+    static std::uint64_t value(NovaCounter counter); // summed over all threads since the last reset
+    static void reset(); // restarts every counter at 0
+    static bool enabled(); // false when built with NOVA_DISABLE_METRICS
+
+    static const char* name(NovaCounter counter);
+    static std::string prometheus(); // Prometheus text exposition format
+    static std::string json(); // one JSON object, counter name -> value
+
+    struct alignas(64) ThreadCounters {
+        std::atomic<std::uint64_t> values[NUMNOVACOUNTERS];
+    };
+
+private:
+    struct ThreadSlot;
+
+    static void snapshot(std::uint64_t* values);
+    static ThreadCounters* registerThread();
+
+    static inline thread_local ThreadCounters* local = nullptr; // this thread's block, once registered
+};
+
+// Pre-Condition: None
+// Post-Condition: counter of the calling thread is increased by n
+inline void NovaMetrics::add(NovaCounter counter, std::uint64_t n) {
+#ifndef NOVA_DISABLE_METRICS
+    ThreadCounters* counters = local ? local : registerThread();
+    // only this thread writes its block, so a relaxed load and store is enough
+    std::atomic<std::uint64_t>& slot = counters->values[static_cast<int>(counter)];
+    slot.store(slot.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+    (void)counter;
+    (void)n;
+#endif
+}
+
+#endif // NOVA_METRICS_H
+
+
+/*
+Class invariants for NovaMetrics:
+
+- Each thread's ThreadCounters block is written by that thread only, and starts on its own
+  cache line.
+- value(c) == (events counted for c by live threads + by threads that have exited) - the
+  value c had at the last reset().
+*/
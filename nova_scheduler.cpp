@@ -0,0 +1,233 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The NovaScheduler class runs glow(x) ticks on a Nova as events. A glowing lumen goes through at
+most three phases: active, where its glow value (brightness * size) does not depend on power;
+erratic, where the value changes with every point of power; and dimmed, where it is fixed
+again. Only the step out of the active phase is put on the timing wheel; erratic lumens are
+visited on every tick until they are dimmed, and dimmed lumens are never visited again.
+
+Once more than half of the lumens are inactive, glow(x) recharges the active lumens after every
+tick, and the number of inactive lumens can never drop again. The first recharge is done for
+real; from then on a glowing active lumen is either back at powerCopy after every tick (steady,
+no work at all) or turns inactive on the very next tick, which is scheduled like any other
+crossing.
+
+ASSUMPTIONS:
+- The Nova is not used directly, moved or destroyed while the scheduler is attached (the
+  scheduler flushes into it when destroyed).
+*/
+
+#include "nova_scheduler.h"
+#include <stdexcept>
+
+// Pre-Condition: 0 <= x <= nova.getNumLumens()
+// Post-Condition: a scheduler that glows the first x lumens of nova on every tick is attached
+NovaScheduler::NovaScheduler(Nova& nova, int x)
+    : nova(nova), bank(nova.ownBank()), x(x), now(0), flushedAt(0), recharging(false),
+      wasPinned(nova.lumensPinned) {
+    if (x < 0 || x > bank.size()) {
+        throw std::out_of_range("Invalid number of lumens to glow.");
+    }
+    // the scheduler writes into the bank, so copies of the Nova must not share it
+    nova.lumensPinned = true;
+
+    basePower.assign(bank.power, bank.power + x);
+    baseTick.assign(x, 0);
+    steady.assign(x, 0);
+    eventTick.assign(x, -1);
+    for (int i = 0; i < x; i++) {
+        follow(i);
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the Nova holds the state of every tick run and is detached from the scheduler
+NovaScheduler::~NovaScheduler() {
+    flush();
+    nova.lumensPinned = wasPinned;
+}
+
+// Pre-Condition: None
+// Post-Condition: the Nova is in the state nova.glow(x) would leave it in
+void NovaScheduler::tick() {
+    now++;
+    wheel.advance(due);
+    NovaMetrics::add(NovaCounter::NovaGlows);
+    NovaMetrics::add(NovaCounter::LumenGlows, static_cast<std::uint64_t>(x));
+
+    // erratic lumens change their glow value on every tick, until they are dimmed
+    for (size_t k = 0; k < erratic.size();) {
+        int i = erratic[k];
+        int p = powerAt(i);
+        int oldValue = bank.glowValueAt(i, p + 1);
+        bank.power[i] = p;
+        bank.track(i, LumenState::Erratic, oldValue);
+        if (p > LumenBank::INACTIVESTATE) {
+            k++;
+        } else {
+            erratic[k] = erratic.back();
+            erratic.pop_back();
+        }
+    }
+
+    // active lumens whose power reached their threshold on this tick
+    for (int i : due) {
+        if (eventTick[i] != now) {
+            continue; // rescheduled by a recharge
+        }
+        eventTick[i] = -1;
+        int p = powerAt(i);
+        int oldValue = bank.glowValueAt(i, p + 1);
+        bank.power[i] = p;
+        bank.track(i, LumenState::Active, oldValue);
+        if (bank.stateAt(i, p) == LumenState::Erratic) {
+            erratic.push_back(i);
+        }
+    }
+
+    // same rule as Nova::rechargeInactiveLumens; after the first recharge, every later one
+    // leaves the lumens exactly as they are
+    if (recharging) {
+        NovaMetrics::add(NovaCounter::RechargeRounds);
+    } else if (bank.countInactive() > bank.size() / 2) {
+        NovaMetrics::add(NovaCounter::RechargeRounds);
+        firstRecharge();
+    }
+}
+
+// Pre-Condition: ticks should be non-negative
+// Post-Condition: the Nova is in the state ticks calls of nova.glow(x) would leave it in
+void NovaScheduler::tick(int ticks) {
+    if (ticks < 0) {
+        throw std::out_of_range("Invalid number of glow ticks.");
+    }
+    for (int t = 0; t < ticks; t++) {
+        tick();
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the power and glowRequest of every lumen are stored in the Nova
+void NovaScheduler::flush() {
+    int elapsed = static_cast<int>(now - flushedAt);
+    for (int i = 0; i < x; i++) {
+        int p = powerAt(i);
+        bank.power[i] = p;
+        bank.glowRequest[i] += elapsed;
+        if (!steady[i]) {
+            basePower[i] = p;
+            baseTick[i] = now;
+        }
+    }
+    flushedAt = now;
+    // the glowing lumens are no longer at powerCopy unless a recharge put them there
+    bank.markDirty(0, x);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of ticks run
+long long NovaScheduler::getTicks() const {
+    return now;
+}
+
+// Pre-Condition: the Nova has at least one lumen
+// Post-Condition: Returns the smallest glow value of the Nova after the last tick
+int NovaScheduler::minGlow() const {
+    return nova.minGlow();
+}
+
+// Pre-Condition: the Nova has at least one lumen
+// Post-Condition: Returns the largest glow value of the Nova after the last tick
+int NovaScheduler::maxGlow() const {
+    return nova.maxGlow();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of active lumens after the last tick
+int NovaScheduler::getNumActiveLumens() const {
+    return nova.getNumActiveLumens();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of erratic lumens after the last tick
+int NovaScheduler::getNumErraticLumens() const {
+    return nova.getNumErraticLumens();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of inactive lumens after the last tick
+int NovaScheduler::getNumInactiveLumens() const {
+    return nova.getNumInactiveLumens();
+}
+
+// Pre-Condition: 0 <= index < x
+// Post-Condition: Returns the power glowing lumen index has after the last tick
+int NovaScheduler::powerAt(int index) const {
+    if (steady[index]) {
+        return bank.powerCopy[index];
+    }
+    return static_cast<int>(basePower[index] - (now - baseTick[index]));
+}
+
+// Pre-Condition: 0 <= index < x; the lumen is active and not steady
+// Post-Condition: the lumen's threshold crossing is on the wheel
+void NovaScheduler::schedule(int index) {
+    eventTick[index] = baseTick[index] + basePower[index] - bank.powerThreshold[index];
+    wheel.schedule(index, eventTick[index]);
+}
+
+// Pre-Condition: 0 <= index < x; basePower and baseTick describe the lumen
+// Post-Condition: the lumen is scheduled if active, in the erratic list if erratic
+void NovaScheduler::follow(int index) {
+    LumenState state = bank.stateAt(index, powerAt(index));
+    if (state == LumenState::Active) {
+        schedule(index);
+    } else if (state == LumenState::Erratic) {
+        erratic.push_back(index);
+    }
+}
+
+// Pre-Condition: no recharge has run yet and more than half of the lumens are inactive
+// Post-Condition: every active lumen is recharged, as LumenBank::rechargeActive() does, and
+//                 every glowing one is steady or scheduled again
+void NovaScheduler::firstRecharge() {
+    recharging = true;
+    for (int i = 0; i < bank.size(); i++) {
+        int p = i < x ? powerAt(i) : bank.power[i];
+        if (p <= bank.powerThreshold[i]) {
+            continue;
+        }
+        int oldValue = bank.glowValueAt(i, p);
+        bank.power[i] = bank.powerCopy[i];
+        bank.charged[i] = true;
+        // only lumens built with Lumen arithmetic can turn inactive here
+        bank.track(i, LumenState::Active, oldValue);
+        if (i >= x) {
+            continue;
+        }
+        basePower[i] = bank.powerCopy[i];
+        baseTick[i] = now;
+        eventTick[i] = -1;
+        if (bank.powerCopy[i] - 1 > bank.powerThreshold[i]) {
+            // one glow never takes it down to the threshold, so every tick ends back at powerCopy
+            steady[i] = 1;
+        } else {
+            follow(i);
+        }
+    }
+}
+
+
+/*
+Implementation Invariant:
+- Lumens [x, size) are never glowed, so their stored columns are always current; only the
+  first recharge changes them.
+- The erratic lumens are visited before the events of a tick, so a lumen that turns erratic on
+  a tick is not stepped twice on it.
+- A rescheduled lumen's old wheel entry is recognized by eventTick and skipped.
+*/
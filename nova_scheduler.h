@@ -0,0 +1,87 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaScheduler.h is the header file for the NovaScheduler class, the event-driven way to run a
+Nova through many glow(x) ticks with the same x. Every glow takes exactly one point of power
+from each of the first x lumens, so the tick at which an active lumen falls to its
+powerThreshold is known in advance. The scheduler keeps the power of those lumens lazily (the
+power they had at a known tick, minus the ticks since) and puts each active lumen's crossing on a
+TimingWheel. A tick then only touches the lumens that change state on it and the erratic lumens,
+whose glow value follows their power; lumens that stay active cost nothing.
+
+While a scheduler is attached, the Nova's counts and glow values (minGlow, maxGlow, the state
+counters) are always exact and can be read through the scheduler, but the stored power and
+glowRequest of the glowing lumens are only brought up to date by flush(). The Nova must not be
+used directly between creating the scheduler and the last flush() (the destructor flushes).
+*/
+
+#ifndef NOVA_SCHEDULER_H
+#define NOVA_SCHEDULER_H
+
+#include "nova.h"
+#include "timing_wheel.h"
+#include <vector>
+
+class NovaScheduler {
+public:
+    NovaScheduler(Nova& nova, int x); // every tick glows the first x lumens of nova
+    ~NovaScheduler();
+    NovaScheduler(const NovaScheduler&) = delete;
+    NovaScheduler& operator=(const NovaScheduler&) = delete;
+
+    void tick(); // same as nova.glow(x)
+    void tick(int ticks); // same as ticks calls of nova.glow(x)
+    void flush(); // stores the current power and glowRequest of every lumen in the Nova
+
+    long long getTicks() const; // ticks run since the scheduler was created
+    int minGlow() const;
+    int maxGlow() const;
+    int getNumActiveLumens() const;
+    int getNumErraticLumens() const;
+    int getNumInactiveLumens() const;
+
+private:
+    Nova& nova;
+    LumenBank& bank;
+    int x;
+
+    long long now; // ticks run so far
+    long long flushedAt; // tick of the last flush, glowRequest is stored up to it
+    bool recharging; // a recharge has run; from then on one runs after every tick
+    bool wasPinned; // the Nova's lumensPinned before the scheduler was attached
+
+    // Lazy power of glowing lumen i: powerCopy if steady, else basePower - (now - baseTick)
+    std::vector<int> basePower;
+    std::vector<long long> baseTick;
+    std::vector<char> steady; // active and recharged back to powerCopy after every tick
+    std::vector<long long> eventTick; // tick of the pending threshold crossing, or -1
+
+    std::vector<int> erratic; // glowing lumens that are erratic, their value changes every tick
+    TimingWheel wheel;
+    std::vector<int> due; // scratch list of the events of one tick
+
+    int powerAt(int index) const;
+    void schedule(int index);
+    void follow(int index);
+    void firstRecharge();
+};
+
+#endif // NOVA_SCHEDULER_H
+
+
+/*
+Class invariants for NovaScheduler:
+
+- 0 <= x <= number of lumens of the Nova, which does not change while the scheduler is attached.
+- The Nova's glow order and state counters describe every lumen at its lazy power: powerAt(i)
+  for i < x, the stored power for the others. A glowing lumen whose stored power is behind is
+  still active at it, and an active lumen's glow value does not depend on power, so a scan of
+  the stored columns (glowStats, glowPercentile) finds the same glow values as the glow order.
+- Every glowing active lumen is either steady or has exactly one pending event, at the tick its
+  lazy power reaches its powerThreshold; erratic holds exactly the glowing erratic lumens.
+- After flush() the Nova's columns are exactly what now calls of glow(x) would have left.
+*/
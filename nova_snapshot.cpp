@@ -0,0 +1,338 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The NovaSnapshot class writes and reads snapshots in this layout (native byte order, checked
+through the byte order mark):
+
+    header:  "NOVA"  uint32 VERSION  uint32 0x01020304  uint32 kind
+    Lumen:   the eleven Lumen fields, ten int32 followed by charged as one byte
+    Nova:    int32 numLumens, then each column of the lumen bank as numLumens values in the
+             order brightness, size, power, brightnessCopy, powerCopy, dimmingValue,
+             powerThreshold, glowRequest, maxReset, resetCount (int32) and charged (bytes)
+    fleet:   int32 number of entries, then per entry one byte (0 for an empty unique_ptr)
+             followed by a Nova record when the byte is 1
+
+Columns move with one stream read or write each. A restored Nova gets its bank through a
+single exact-size allocation; the glow order and state counters are rebuilt from the columns.
+The lumen count of a record is untrusted: a negative count is rejected, and a record larger than
+FILEBUFFER is only allocated once the stream is known to hold it. The lumen fields themselves are
+restored as saved, so a lumen changed by Lumen arithmetic comes back exactly as it was written.
+
+ASSUMPTIONS:
+- Snapshots are read back on a machine with the same int size and byte order.
+- The factory passed to the readers is the one later operations should illuminate through;
+  the restored lumens themselves go straight into the bank and never pass through it.
+- Any int value is a valid lumen field; Lumen arithmetic can leave derived fields such as
+  dimmingValue or maxReset out of step with brightness, size and power, and such lumens are
+  saved and restored as they are.
+*/
+
+#include "nova_snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+
+static_assert(sizeof(bool) == 1, "charged columns are stored as one byte per lumen");
+
+namespace {
+
+constexpr char MAGIC[4] = {'N', 'O', 'V', 'A'};
+constexpr std::uint32_t BYTEORDER = 0x01020304;
+constexpr std::size_t FILEBUFFER = 1 << 20;
+constexpr int NUMINTFIELDS = 10;
+constexpr std::streamoff LUMENBYTES = NUMINTFIELDS * sizeof(std::int32_t) + 1; // one lumen of a Nova record
+
+// Pre-Condition: None
+// Post-Condition: the bytes of value are written to out
+template <class T>
+void put(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the next value in; throws if the snapshot ends early
+template <class T>
+T get(std::istream& in) {
+    T value{};
+    if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+        throw std::runtime_error("Snapshot is truncated.");
+    }
+    return value;
+}
+
+// Pre-Condition: column holds n values
+// Post-Condition: the n values are written with one stream write
+template <class T>
+void putColumn(std::ostream& out, const T* column, int n) {
+    out.write(reinterpret_cast<const char*>(column), static_cast<std::streamsize>(n) * sizeof(T));
+}
+
+// Pre-Condition: column has room for n values
+// Post-Condition: the next n values of in are read into column with one stream read
+template <class T>
+void getColumn(std::istream& in, T* column, int n) {
+    if (!in.read(reinterpret_cast<char*>(column), static_cast<std::streamsize>(n) * sizeof(T))) {
+        throw std::runtime_error("Snapshot is truncated.");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of bytes left in in, or -1 if the stream cannot tell;
+//                 the read position is unchanged
+std::streamoff remainingBytes(std::istream& in) {
+    std::streambuf* buffer = in.rdbuf();
+    std::streampos here = buffer->pubseekoff(0, std::ios::cur, std::ios::in);
+    if (here == std::streampos(-1)) {
+        return -1;
+    }
+    std::streampos end = buffer->pubseekoff(0, std::ios::end, std::ios::in);
+    buffer->pubseekpos(here, std::ios::in);
+    return end == std::streampos(-1) ? -1 : static_cast<std::streamoff>(end - here);
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the next bytes bytes of in, read FILEBUFFER bytes at a time so the
+//                 buffer only grows with data the stream actually holds; throws if it ends early
+std::vector<char> getChunked(std::istream& in, std::streamoff bytes) {
+    std::vector<char> record;
+    while (static_cast<std::streamoff>(record.size()) < bytes) {
+        std::size_t done = record.size();
+        std::size_t chunk = static_cast<std::size_t>(std::min<std::streamoff>(bytes - static_cast<std::streamoff>(done), FILEBUFFER));
+        record.resize(done + chunk);
+        getColumn(in, record.data() + done, static_cast<int>(chunk));
+    }
+    return record;
+}
+
+} // namespace
+
+/************************************ Writing *****************************************************/
+
+// Pre-Condition: out is a binary stream
+// Post-Condition: a snapshot of lumen is appended to out
+void NovaSnapshot::write(std::ostream& out, const Lumen& lumen) {
+    writeHeader(out, Kind::Lumen);
+    const int fields[] = {lumen.brightness, lumen.size, lumen.power, lumen.brightnessCopy, lumen.powerCopy,
+                          lumen.dimmingValue, lumen.powerThreshold, lumen.glowRequest, lumen.maxReset,
+                          lumen.resetCount};
+    putColumn(out, fields, NUMINTFIELDS);
+    put(out, static_cast<std::uint8_t>(lumen.charged));
+}
+
+// Pre-Condition: out is a binary stream
+// Post-Condition: a snapshot of nova is appended to out
+void NovaSnapshot::write(std::ostream& out, const Nova& nova) {
+    writeHeader(out, Kind::Nova);
+    writeNovaBody(out, nova);
+}
+
+// Pre-Condition: out is a binary stream
+// Post-Condition: a snapshot of every Nova of fleet (and of its empty slots) is appended to out
+void NovaSnapshot::write(std::ostream& out, const std::vector<std::unique_ptr<Nova>>& fleet) {
+    writeHeader(out, Kind::Fleet);
+    put(out, static_cast<std::int32_t>(fleet.size()));
+    for (const std::unique_ptr<Nova>& nova : fleet) {
+        put(out, static_cast<std::uint8_t>(nova ? 1 : 0));
+        if (nova) {
+            writeNovaBody(out, *nova);
+        }
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: fleet is saved to the file at path, replacing it; throws if that fails
+void NovaSnapshot::saveFleet(const std::string& path, const std::vector<std::unique_ptr<Nova>>& fleet) {
+    std::vector<char> buffer(FILEBUFFER);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open snapshot file for writing.");
+    }
+    write(out, fleet);
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Cannot write snapshot file.");
+    }
+}
+
+/************************************ Reading *****************************************************/
+
+// Pre-Condition: in is positioned at a Lumen snapshot
+// Post-Condition: returns the saved Lumen; throws std::runtime_error on a bad snapshot
+Lumen NovaSnapshot::readLumen(std::istream& in) {
+    readHeader(in, Kind::Lumen);
+    int fields[NUMINTFIELDS];
+    getColumn(in, fields, NUMINTFIELDS);
+    Lumen lumen(1, 1, 1);
+    lumen.brightness = fields[0];
+    lumen.size = fields[1];
+    lumen.power = fields[2];
+    lumen.brightnessCopy = fields[3];
+    lumen.powerCopy = fields[4];
+    lumen.dimmingValue = fields[5];
+    lumen.powerThreshold = fields[6];
+    lumen.glowRequest = fields[7];
+    lumen.maxReset = fields[8];
+    lumen.resetCount = fields[9];
+    lumen.charged = get<std::uint8_t>(in) != 0;
+    return lumen;
+}
+
+// Pre-Condition: in is positioned at a Nova snapshot
+// Post-Condition: returns the saved Nova, illuminating through luminate from now on
+Nova NovaSnapshot::readNova(std::istream& in, ILuminosity* luminate) {
+    readHeader(in, Kind::Nova);
+    return readNovaBody(in, luminate);
+}
+
+// Pre-Condition: in is positioned at a fleet snapshot
+// Post-Condition: returns the saved fleet, every Nova illuminating through luminate from now on
+std::vector<std::unique_ptr<Nova>> NovaSnapshot::readFleet(std::istream& in, ILuminosity* luminate) {
+    readHeader(in, Kind::Fleet);
+    std::int32_t numNovas = get<std::int32_t>(in);
+    if (numNovas < 0) {
+        throw std::runtime_error("Snapshot holds a negative number of Novas.");
+    }
+    std::vector<std::unique_ptr<Nova>> fleet;
+    fleet.reserve(std::min<std::int32_t>(numNovas, 4096)); // a corrupt count fails on read, not here
+    for (std::int32_t i = 0; i < numNovas; i++) {
+        std::uint8_t present = get<std::uint8_t>(in);
+        if (present > 1) {
+            throw std::runtime_error("Snapshot is corrupt.");
+        }
+        fleet.push_back(present ? std::unique_ptr<Nova>(new Nova(readNovaBody(in, luminate))) : nullptr);
+    }
+    return fleet;
+}
+
+// Pre-Condition: path names a fleet snapshot written by saveFleet
+// Post-Condition: returns the saved fleet; throws if the file cannot be read or is not a fleet snapshot
+std::vector<std::unique_ptr<Nova>> NovaSnapshot::loadFleet(const std::string& path, ILuminosity* luminate) {
+    std::vector<char> buffer(FILEBUFFER);
+    std::ifstream in;
+    in.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    in.open(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open snapshot file for reading.");
+    }
+    return readFleet(in, luminate);
+}
+
+/************************************ Helpers *****************************************************/
+
+// Pre-Condition: None
+// Post-Condition: the snapshot header for a record of kind is written to out
+void NovaSnapshot::writeHeader(std::ostream& out, Kind kind) {
+    out.write(MAGIC, sizeof(MAGIC));
+    put(out, VERSION);
+    put(out, BYTEORDER);
+    put(out, static_cast<std::uint32_t>(kind));
+}
+
+// Pre-Condition: None
+// Post-Condition: a valid header for a record of kind is consumed; otherwise std::runtime_error is thrown
+void NovaSnapshot::readHeader(std::istream& in, Kind kind) {
+    char magic[sizeof(MAGIC)];
+    getColumn(in, magic, sizeof(MAGIC));
+    if (!std::equal(magic, magic + sizeof(MAGIC), MAGIC)) {
+        throw std::runtime_error("Not a Nova snapshot.");
+    }
+    if (get<std::uint32_t>(in) != VERSION) {
+        throw std::runtime_error("Unsupported Nova snapshot version.");
+    }
+    if (get<std::uint32_t>(in) != BYTEORDER) {
+        throw std::runtime_error("Nova snapshot was written with a different byte order.");
+    }
+    if (get<std::uint32_t>(in) != static_cast<std::uint32_t>(kind)) {
+        throw std::runtime_error("Nova snapshot holds a different kind of record.");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the lumen count and every bank column of nova are written to out
+void NovaSnapshot::writeNovaBody(std::ostream& out, const Nova& nova) {
+    const LumenBank& bank = nova.bank();
+    int n = bank.size();
+    put(out, static_cast<std::int32_t>(n));
+    if (n == 0) {
+        return;
+    }
+    const int* columns[] = {bank.brightness, bank.sizes, bank.power, bank.brightnessCopy, bank.powerCopy,
+                            bank.dimmingValue, bank.powerThreshold, bank.glowRequest, bank.maxReset,
+                            bank.resetCount};
+    for (const int* column : columns) {
+        putColumn(out, column, n);
+    }
+    putColumn(out, bank.charged, n);
+}
+
+// Pre-Condition: in is positioned at a Nova record
+// Post-Condition: returns the Nova it describes, its bank allocated once at its final size; throws
+//                 std::runtime_error if the record is truncated or its count is negative, before
+//                 allocating for a count the stream cannot hold
+Nova NovaSnapshot::readNovaBody(std::istream& in, ILuminosity* luminate) {
+    std::int32_t n = get<std::int32_t>(in);
+    if (n < 0) {
+        throw std::runtime_error("Snapshot holds a negative number of lumens.");
+    }
+    Nova nova(luminate);
+    if (n == 0) {
+        return nova;
+    }
+    // a large record is only allocated once the stream is known to hold it: checked against the
+    // bytes left when the stream can tell, otherwise staged in bounded chunks first
+    std::streamoff bytes = n * LUMENBYTES;
+    std::vector<char> staged;
+    if (bytes > static_cast<std::streamoff>(FILEBUFFER)) {
+        std::streamoff remaining = remainingBytes(in);
+        if (remaining >= 0 && remaining < bytes) {
+            throw std::runtime_error("Snapshot is truncated.");
+        }
+        if (remaining < 0) {
+            staged = getChunked(in, bytes);
+        }
+    }
+    LumenBank& bank = nova.ownBank(n);
+    int* columns[] = {bank.brightness, bank.sizes, bank.power, bank.brightnessCopy, bank.powerCopy,
+                      bank.dimmingValue, bank.powerThreshold, bank.glowRequest, bank.maxReset,
+                      bank.resetCount};
+    // read the flags as bytes so a corrupt snapshot can never produce an invalid bool
+    unsigned char* charged = reinterpret_cast<unsigned char*>(bank.charged);
+    if (staged.empty()) {
+        for (int* column : columns) {
+            getColumn(in, column, n);
+        }
+        getColumn(in, charged, n);
+    } else {
+        const char* next = staged.data();
+        for (int* column : columns) {
+            std::memcpy(column, next, sizeof(int) * n);
+            next += sizeof(int) * n;
+        }
+        std::memcpy(charged, next, n);
+    }
+    for (int i = 0; i < n; i++) {
+        charged[i] = charged[i] != 0;
+    }
+    bank.count = n;
+    bank.rebuildTracking();
+    return nova;
+}
+
+/*
+Implementation Invariant:
+- The bank of a Nova being restored keeps count == 0 until every column has been read, so a
+  snapshot that ends early throws without leaving half-initialized lumens behind.
+- readNovaBody() allocates the bank once through ownBank(n), which reserves exactly n lumens, and
+  only after the stream has shown it holds n lumens whenever they take more than FILEBUFFER
+  bytes; a stream that cannot tell its size is staged chunk by chunk, so memory only grows
+  with data actually read.
+*/
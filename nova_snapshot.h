@@ -0,0 +1,66 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaSnapshot.h is the header file for the NovaSnapshot class, which saves the complete state of
+a Lumen, a Nova or a whole fleet of Novas (as P4 keeps them, vector<unique_ptr<Nova>>) to a
+versioned binary snapshot and restores it. A long simulation can then be checkpointed and picked
+up again from the snapshot instead of being replayed from the constructors.
+
+A Nova is written column by column, straight from its lumen bank, and restored by reading the
+columns straight into a bank allocated once at its final size.
+*/
+
+#ifndef NOVA_SNAPSHOT_H
+#define NOVA_SNAPSHOT_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "nova.h"
+
+class NovaSnapshot {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    static void write(std::ostream& out, const Lumen& lumen);
+    static void write(std::ostream& out, const Nova& nova);
+    static void write(std::ostream& out, const std::vector<std::unique_ptr<Nova>>& fleet);
+
+    static Lumen readLumen(std::istream& in);
+    static Nova readNova(std::istream& in, ILuminosity* luminate);
+    static std::vector<std::unique_ptr<Nova>> readFleet(std::istream& in, ILuminosity* luminate);
+
+    // Whole-file versions with a large write/read buffer
+    static void saveFleet(const std::string& path, const std::vector<std::unique_ptr<Nova>>& fleet);
+    static std::vector<std::unique_ptr<Nova>> loadFleet(const std::string& path, ILuminosity* luminate);
+
+private:
+    enum class Kind : std::uint32_t {
+        Lumen = 1,
+        Nova = 2,
+        Fleet = 3
+    };
+
+    static void writeHeader(std::ostream& out, Kind kind);
+    static void readHeader(std::istream& in, Kind kind);
+    static void writeNovaBody(std::ostream& out, const Nova& nova);
+    static Nova readNovaBody(std::istream& in, ILuminosity* luminate);
+};
+
+#endif // NOVA_SNAPSHOT_H
+
+
+/*
+Class invariants for NovaSnapshot:
+
+- Every snapshot starts with the magic "NOVA", the format VERSION, a byte order mark and the
+  kind of record that follows; readers reject anything else with std::runtime_error.
+- Restoring a snapshot yields objects whose every field, and so every later operation, matches
+  the objects that were saved.
+*/
@@ -0,0 +1,361 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The FleetImage class writes and maps fleet images in this layout (native byte order, checked
+through the byte order mark):
+
+    header (64 bytes):  "NOVAFLT" '\0', uint32 VERSION, uint32 0x01020304, int64 number of
+                        fleet entries, zero padding
+    table:              one 24-byte Entry per fleet entry
+    columns:            per Nova, starting at its Entry offset: brightness, size, power,
+                        brightnessCopy, powerCopy, dimmingValue, powerThreshold, glowRequest,
+                        maxReset, resetCount (int32) and charged (bytes), each column padded
+                        to a multiple of 64 bytes
+
+Every column starts 64-byte aligned in the file, and so in the mapping. The image holds the
+complete bank state, but NovaView only reads the five columns currentGlowValue needs.
+
+ASSUMPTIONS:
+- Images are read on a machine with the same int size and byte order as the writer.
+- The image file is not changed while it is mapped.
+- The platform has POSIX open/fstat/mmap; without NOVA_FLEET_IMAGE the file compiles to nothing.
+*/
+
+#include "nova_view.h"
+
+#ifdef NOVA_FLEET_IMAGE
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct FleetImage::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::int64_t numNovas;
+    char padding[40];
+};
+
+struct FleetImage::Entry {
+    std::int64_t offset; // file offset of the first column
+    std::int32_t numLumens; // -1 for an empty fleet entry
+    std::int32_t minGlow;
+    std::int32_t maxGlow;
+    std::int32_t reserved;
+};
+
+static_assert(sizeof(FleetImage::Header) == 64, "image header is one cache line");
+static_assert(sizeof(FleetImage::Entry) == 24, "image table entries are 24 bytes");
+
+namespace {
+
+constexpr char MAGIC[8] = {'N', 'O', 'V', 'A', 'F', 'L', 'T', '\0'};
+constexpr std::uint32_t BYTEORDER = 0x01020304;
+constexpr std::int64_t COLUMNALIGN = 64;
+constexpr int NUMINTCOLUMNS = 10;
+constexpr std::size_t FILEBUFFER = 1 << 20;
+
+// Column positions inside a Nova's column area
+enum Column { BRIGHTNESS, SIZE, POWER, BRIGHTNESSCOPY, POWERCOPY, DIMMINGVALUE, POWERTHRESHOLD,
+              GLOWREQUEST, MAXRESET, RESETCOUNT, CHARGED };
+
+// Pre-Condition: bytes is non-negative
+// Post-Condition: returns bytes rounded up to a whole number of cache lines
+std::int64_t padded(std::int64_t bytes) {
+    return (bytes + COLUMNALIGN - 1) / COLUMNALIGN * COLUMNALIGN;
+}
+
+// Pre-Condition: numLumens is non-negative
+// Post-Condition: returns the bytes taken by the columns of a Nova with numLumens lumens
+std::int64_t columnsBytes(std::int64_t numLumens) {
+    return padded(numLumens * static_cast<std::int64_t>(sizeof(int))) * NUMINTCOLUMNS + padded(numLumens);
+}
+
+// Pre-Condition: 0 <= column <= CHARGED
+// Post-Condition: returns the offset of column inside a Nova's column area
+std::int64_t columnOffset(std::int64_t numLumens, int column) {
+    return padded(numLumens * static_cast<std::int64_t>(sizeof(int))) * column;
+}
+
+// Pre-Condition: out is a binary stream
+// Post-Condition: bytes zero bytes are written to out
+void putZeros(std::ostream& out, std::int64_t bytes) {
+    static const char zeros[COLUMNALIGN] = {};
+    while (bytes > 0) {
+        std::int64_t chunk = std::min(bytes, COLUMNALIGN);
+        out.write(zeros, static_cast<std::streamsize>(chunk));
+        bytes -= chunk;
+    }
+}
+
+// Pre-Condition: column holds n values
+// Post-Condition: the column is written to out, padded to whole cache lines
+template <class T>
+void putColumn(std::ostream& out, const T* column, int n) {
+    std::int64_t bytes = static_cast<std::int64_t>(n) * sizeof(T);
+    out.write(reinterpret_cast<const char*>(column), static_cast<std::streamsize>(bytes));
+    putZeros(out, padded(bytes) - bytes);
+}
+
+} // namespace
+
+/************************************ NovaView ****************************************************/
+
+// Pre-Condition: the columns hold numLumens values each
+// Post-Condition: a view over the given columns is created
+NovaView::NovaView(int numLumens, int minValue, int maxValue, const int* brightness, const int* size,
+                   const int* power, const int* powerThreshold, const int* dimmingValue)
+: numLumens(numLumens), minValue(minValue), maxValue(maxValue), brightness(brightness), size(size),
+  power(power), powerThreshold(powerThreshold), dimmingValue(dimmingValue) {}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of lumens of the saved Nova
+int NovaView::getNumLumens() const {
+    return numLumens;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the minimum glow value of the saved Nova
+int NovaView::minGlow() const {
+    if (numLumens == 0) {
+        throw std::runtime_error("No lumens in the Nova object.");
+    }
+    return minValue;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the maximum glow value of the saved Nova
+int NovaView::maxGlow() const {
+    if (numLumens == 0) {
+        throw std::runtime_error("No lumens in the Nova object.");
+    }
+    return maxValue;
+}
+
+// Pre-Condition: 0 <= index < getNumLumens()
+// Post-Condition: Returns the glow value the saved lumen had, computed from the mapped columns
+int NovaView::currentGlowValue(int index) const {
+    if (index < 0 || index >= numLumens) {
+        throw std::out_of_range("Invalid lumen index.");
+    }
+    unsigned litValue = static_cast<unsigned>(brightness[index]) * static_cast<unsigned>(size[index]);
+    int p = power[index];
+    if (p > powerThreshold[index]) {
+        return static_cast<int>(litValue);
+    }
+    if (p > 0) {
+        int erraticFactor = 10;
+        return static_cast<int>(litValue * static_cast<unsigned>(p + erraticFactor));
+    }
+    return dimmingValue[index];
+}
+
+/************************************ FleetImage **************************************************/
+
+// Pre-Condition: path names an image written by FleetImage::write
+// Post-Condition: the image is mapped read-only and its header and table are checked;
+//                 throws std::runtime_error if the file cannot be mapped or is not a valid image
+FleetImage::FleetImage(const std::string& path) : base(nullptr), length(0), entries(nullptr), numNovas(0) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open fleet image.");
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(Header))) {
+        ::close(fd);
+        throw std::runtime_error("Not a fleet image.");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map fleet image.");
+    }
+    base = static_cast<const char*>(mapping);
+
+    try {
+        const Header* header = reinterpret_cast<const Header*>(base);
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a fleet image.");
+        }
+        if (header->version != VERSION) {
+            throw std::runtime_error("Unsupported fleet image version.");
+        }
+        if (header->byteOrder != BYTEORDER) {
+            throw std::runtime_error("Fleet image was written with a different byte order.");
+        }
+        if (header->numNovas < 0 || header->numNovas > INT32_MAX) {
+            throw std::runtime_error("Fleet image is corrupt.");
+        }
+        std::int64_t tableEnd = static_cast<std::int64_t>(sizeof(Header) + header->numNovas * sizeof(Entry));
+        if (tableEnd > static_cast<std::int64_t>(length)) {
+            throw std::runtime_error("Fleet image is truncated.");
+        }
+        numNovas = static_cast<int>(header->numNovas);
+        entries = reinterpret_cast<const Entry*>(base + sizeof(Header));
+        for (int i = 0; i < numNovas; i++) {
+            const Entry& entry = entries[i];
+            if (entry.numLumens < 0) {
+                continue;
+            }
+            if (entry.offset < tableEnd || entry.offset % COLUMNALIGN != 0
+                || entry.offset + columnsBytes(entry.numLumens) > static_cast<std::int64_t>(length)) {
+                throw std::runtime_error("Fleet image is truncated.");
+            }
+        }
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the image is unmapped; views taken from it must no longer be used
+FleetImage::~FleetImage() {
+    unmap();
+}
+
+// Pre-Condition: None
+// Post-Condition: this takes over the mapping of other, which is left empty
+FleetImage::FleetImage(FleetImage&& other) noexcept
+: base(other.base), length(other.length), entries(other.entries), numNovas(other.numNovas) {
+    other.base = nullptr;
+    other.length = 0;
+    other.entries = nullptr;
+    other.numNovas = 0;
+}
+
+// Pre-Condition: None
+// Post-Condition: this takes over the mapping of other; its own mapping is released
+FleetImage& FleetImage::operator=(FleetImage&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+        std::swap(entries, other.entries);
+        std::swap(numNovas, other.numNovas);
+    }
+    return *this;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of fleet entries in the image
+int FleetImage::size() const {
+    return numNovas;
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns true if the fleet held a Nova at index
+bool FleetImage::hasNova(int index) const {
+    if (index < 0 || index >= numNovas) {
+        throw std::out_of_range("Invalid Nova index.");
+    }
+    return entries[index].numLumens >= 0;
+}
+
+// Pre-Condition: hasNova(index)
+// Post-Condition: Returns a view of the Nova saved at index, reading the mapped columns in place
+NovaView FleetImage::nova(int index) const {
+    if (!hasNova(index)) {
+        throw std::runtime_error("The fleet held no Nova at this index.");
+    }
+    const Entry& entry = entries[index];
+    const char* columns = base + entry.offset;
+    auto column = [&](int c) {
+        return reinterpret_cast<const int*>(columns + columnOffset(entry.numLumens, c));
+    };
+    return NovaView(entry.numLumens, entry.minGlow, entry.maxGlow, column(BRIGHTNESS), column(SIZE),
+                    column(POWER), column(POWERTHRESHOLD), column(DIMMINGVALUE));
+}
+
+// Pre-Condition: None
+// Post-Condition: fleet is written to path as a fleet image, replacing the file; throws if that fails
+void FleetImage::write(const std::string& path, const std::vector<std::unique_ptr<Nova>>& fleet) {
+    std::vector<char> buffer(FILEBUFFER);
+    std::ofstream out;
+    out.rdbuf()->pubsetbuf(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open fleet image for writing.");
+    }
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTEORDER;
+    header.numNovas = static_cast<std::int64_t>(fleet.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::int64_t tableEnd = static_cast<std::int64_t>(sizeof(Header) + fleet.size() * sizeof(Entry));
+    std::int64_t offset = padded(tableEnd);
+    for (const std::unique_ptr<Nova>& nova : fleet) {
+        Entry entry{0, -1, 0, 0, 0};
+        if (nova) {
+            const LumenBank& bank = nova->bank();
+            entry.offset = offset;
+            entry.numLumens = bank.size();
+            if (bank.size() > 0) {
+                entry.minGlow = bank.minGlowValue();
+                entry.maxGlow = bank.maxGlowValue();
+            }
+            offset += columnsBytes(bank.size());
+        }
+        out.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    putZeros(out, padded(tableEnd) - tableEnd);
+
+    for (const std::unique_ptr<Nova>& nova : fleet) {
+        if (!nova) {
+            continue;
+        }
+        const LumenBank& bank = nova->bank();
+        int n = bank.size();
+        const int* columns[NUMINTCOLUMNS] = {bank.brightness, bank.sizes, bank.power, bank.brightnessCopy,
+                                             bank.powerCopy, bank.dimmingValue, bank.powerThreshold,
+                                             bank.glowRequest, bank.maxReset, bank.resetCount};
+        for (const int* column : columns) {
+            putColumn(out, column, n);
+        }
+        putColumn(out, bank.charged, n);
+    }
+
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Cannot write fleet image.");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the mapping, if any, is released
+void FleetImage::unmap() {
+    if (base) {
+        ::munmap(const_cast<char*>(base), length);
+    }
+    base = nullptr;
+    length = 0;
+    entries = nullptr;
+    numNovas = 0;
+}
+
+#endif // NOVA_FLEET_IMAGE
+
+
+/*
+Implementation Invariant:
+- The column order and padding used by write() and by nova() come from the same Column
+  positions and columnOffset(), so a view always reads the columns the writer put there.
+- The constructor checks every table entry against the file length, so a view never reads
+  past the end of the mapping.
+- A Nova with no lumens still has a table entry (numLumens 0) and takes no column space.
+*/
@@ -0,0 +1,107 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+NovaView.h is the header file for the FleetImage and NovaView classes, which read fleet states
+straight from an on-disk columnar fleet image. FleetImage::write saves a fleet (as P4 keeps
+it, vector<unique_ptr<Nova>>) as an image: a table with the lumen count, min and max glow
+value of every Nova, followed by the lumen bank columns of each Nova, every column on its own
+cache line.
+
+Opening a FleetImage maps the file read-only; a NovaView answers getNumLumens, minGlow, maxGlow
+and currentGlowValue directly from the mapped pages. Nothing is copied or allocated per lumen,
+so opening an image only reads its table and a query only pages in what it reads.
+
+Mapping goes through POSIX open/mmap, so both classes exist only where NOVA_FLEET_IMAGE is
+defined (Unix-like systems); elsewhere this header declares nothing and nova_view.cpp compiles
+to nothing.
+*/
+
+#ifndef NOVA_VIEW_H
+#define NOVA_VIEW_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "nova.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NOVA_FLEET_IMAGE 1
+#endif
+
+#ifdef NOVA_FLEET_IMAGE
+
+class NovaView {
+public:
+    int getNumLumens() const;
+    int minGlow() const; // O(1), saved with the image
+    int maxGlow() const; // O(1), saved with the image
+    int currentGlowValue(int index) const; // same value as lumen(index).currentGlowValue() of the saved Nova
+
+private:
+    friend class FleetImage;
+
+    NovaView(int numLumens, int minValue, int maxValue, const int* brightness, const int* size,
+             const int* power, const int* powerThreshold, const int* dimmingValue);
+
+    int numLumens;
+    int minValue;
+    int maxValue;
+    const int* brightness;
+    const int* size;
+    const int* power;
+    const int* powerThreshold;
+    const int* dimmingValue;
+};
+
+class FleetImage {
+public:
+    static constexpr std::uint32_t VERSION = 1;
+
+    explicit FleetImage(const std::string& path);
+    ~FleetImage();
+    FleetImage(const FleetImage&) = delete;
+    FleetImage& operator=(const FleetImage&) = delete;
+    FleetImage(FleetImage&& other) noexcept;
+    FleetImage& operator=(FleetImage&& other) noexcept;
+
+    int size() const; // number of fleet entries, empty ones included
+    bool hasNova(int index) const; // false where the fleet held an empty unique_ptr
+    NovaView nova(int index) const; // valid for as long as this FleetImage is
+
+    static void write(const std::string& path, const std::vector<std::unique_ptr<Nova>>& fleet);
+
+    struct Header;
+    struct Entry;
+
+private:
+    const char* base;
+    std::size_t length;
+    const Entry* entries;
+    int numNovas;
+
+    void unmap();
+};
+
+#endif // NOVA_FLEET_IMAGE
+
+#endif // NOVA_VIEW_H
+
+
+/*
+Class invariants for NovaView:
+
+- Every column pointer refers to numLumens values inside the mapping of the FleetImage it came
+  from, which must outlive the view.
+- minValue and maxValue are the smallest and largest current glow value of the saved Nova.
+
+Class invariants for FleetImage:
+
+- base maps length bytes of a valid image (checked when it was opened) or is nullptr after a move.
+- entries points at the numNovas table entries right after the image header.
+- The image is never written through the mapping.
+*/
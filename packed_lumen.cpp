@@ -0,0 +1,319 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The PackedLumen class implements the Lumen operations directly on the narrow fields. Before a
+field would leave its narrow range (power or brightness counting down past -32768, the glow
+request count passing 65535, the reset count passing 255) the lumen is promoted: its state is
+copied into a heap Lumen and that operation and all later ones are forwarded to it.
+
+ASSUMPTIONS:
+- Lumens are built through the Lumen constructor rules (positive inputs), as with Lumen.
+- The erratic value wraps around like brightness * size * (power + 10) in 32 bits.
+*/
+
+#include "packed_lumen.h"
+#include "nova_metrics.h"
+#include <limits>
+#include <utility>
+
+static_assert(sizeof(PackedLumen) <= 16, "PackedLumen must fit in 16 bytes");
+
+namespace {
+
+constexpr int NARROWMIN = std::numeric_limits<std::int16_t>::min();
+constexpr int NARROWMAX = std::numeric_limits<std::int16_t>::max();
+constexpr int GLOWREQUESTMAX = std::numeric_limits<std::uint16_t>::max();
+constexpr int RESETCOUNTMAX = std::numeric_limits<std::uint8_t>::max();
+
+// Pre-Condition: None
+// Post-Condition: returns true if value fits in a narrow field
+bool narrowFits(int value) {
+    return value >= NARROWMIN && value <= NARROWMAX;
+}
+
+// Same expressions as the Lumen constructor
+int dimmingFor(int brightnessCopy) {
+    return static_cast<int>(brightnessCopy * (10.0 / 100));
+}
+
+int thresholdFor(int powerCopy) {
+    return static_cast<int>(powerCopy * (20.0 / 100));
+}
+
+} // namespace
+
+// Preconditions: inputBrightness, inputSize, and inputPower are positive
+// Postconditions: a PackedLumen equal to Lumen(inputBrightness, inputSize, inputPower) is created
+PackedLumen::PackedLumen(int inputBrightness, int inputSize, int inputPower) {
+    narrow.flags = 0;
+    store(Lumen(inputBrightness, inputSize, inputPower));
+}
+
+// Preconditions: None
+// Postconditions: a PackedLumen holding the state of lumen is created, packed if it fits
+PackedLumen::PackedLumen(const Lumen& lumen) {
+    narrow.flags = 0;
+    store(lumen);
+}
+
+// Preconditions: None
+// Postconditions: this is an independent copy of other
+PackedLumen::PackedLumen(const PackedLumen& other) {
+    if (other.packed()) {
+        narrow = other.narrow;
+    } else {
+        wide.flags = other.wide.flags;
+        wide.lumen = new Lumen(*other.wide.lumen);
+    }
+}
+
+// Preconditions: None
+// Postconditions: this takes over the state of other, which is left packed and valid
+PackedLumen::PackedLumen(PackedLumen&& other) noexcept {
+    if (other.packed()) {
+        narrow = other.narrow;
+    } else {
+        wide = other.wide;
+        other.narrow = Narrow{0, 0, 1, 1, 1, 1, 1, 0};
+    }
+}
+
+// Preconditions: None
+// Postconditions: this is an independent copy of other
+PackedLumen& PackedLumen::operator=(const PackedLumen& other) {
+    if (this != &other) {
+        PackedLumen copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Preconditions: None
+// Postconditions: this takes over the state of other; the previous wide Lumen is released
+PackedLumen& PackedLumen::operator=(PackedLumen&& other) noexcept {
+    if (this != &other) {
+        release();
+        if (other.packed()) {
+            narrow = other.narrow;
+        } else {
+            wide = other.wide;
+            other.narrow = Narrow{0, 0, 1, 1, 1, 1, 1, 0};
+        }
+    }
+    return *this;
+}
+
+// Preconditions: None
+// Postconditions: the wide Lumen, if any, is released
+PackedLumen::~PackedLumen() {
+    release();
+}
+
+// Preconditions: None
+// Postconditions: Returns what Lumen::glow returns
+int PackedLumen::glow() {
+    if (packed() && (narrow.glowRequest == GLOWREQUESTMAX || narrow.power == NARROWMIN)) {
+        promote();
+    }
+    if (!packed()) {
+        return wide.lumen->glow();
+    }
+    narrow.glowRequest++;
+    narrow.power--;
+    return currentGlowValue();
+}
+
+// Preconditions: None
+// Postconditions: Returns what Lumen::reset returns and changes the same fields
+bool PackedLumen::reset() {
+    if (!packed()) {
+        return wide.lumen->reset();
+    }
+    if (narrow.resetCount >= maxReset()) {
+        NovaMetrics::add(NovaCounter::ResetFailures);
+        NovaMetrics::add(NovaCounter::ResetsExhausted);
+        return false;
+    }
+    bool resetRequest = narrow.glowRequest >= 5 && narrow.power > 0;
+    if ((resetRequest && narrow.resetCount == RESETCOUNTMAX) || (!resetRequest && narrow.brightness == NARROWMIN)) {
+        promote();
+        return wide.lumen->reset();
+    }
+    if (resetRequest) {
+        narrow.power = narrow.powerCopy;
+        narrow.brightness = narrow.brightnessCopy;
+        narrow.glowRequest = 0;
+        narrow.resetCount++;
+        NovaMetrics::add(NovaCounter::ResetSuccesses);
+        return true;
+    }
+    narrow.brightness--;
+    NovaMetrics::add(NovaCounter::ResetFailures);
+    return false;
+}
+
+// Pre-condition: None
+// Post-condition: power restored to its original value and charged set to true
+void PackedLumen::recharge() {
+    if (!packed()) {
+        wide.lumen->recharge();
+        return;
+    }
+    narrow.power = narrow.powerCopy;
+    narrow.flags |= CHARGED;
+}
+
+// Preconditions: None
+// Postconditions: Returns true if the lumen is active, otherwise false
+bool PackedLumen::isActive() const {
+    if (!packed()) {
+        return wide.lumen->isActive();
+    }
+    return narrow.power > powerThreshold();
+}
+
+// Preconditions: None
+// Postconditions: Returns true if the lumen is erratic, otherwise false
+bool PackedLumen::isErratic() const {
+    if (!packed()) {
+        return wide.lumen->isErratic();
+    }
+    return narrow.power <= powerThreshold() && narrow.power > 0;
+}
+
+// Pre-condition: None
+// Post-condition: returns what Lumen::currentGlowValue returns
+int PackedLumen::currentGlowValue() const {
+    if (!packed()) {
+        return wide.lumen->currentGlowValue();
+    }
+    unsigned litValue = static_cast<unsigned>(narrow.brightness) * static_cast<unsigned>(narrow.size);
+    int p = narrow.power;
+    if (p > powerThreshold()) {
+        return static_cast<int>(litValue);
+    }
+    if (p > 0) {
+        int erraticFactor = 10;
+        return static_cast<int>(litValue * static_cast<unsigned>(p + erraticFactor));
+    }
+    return dimmingValue();
+}
+
+// Preconditions: None
+// Postconditions: Returns the current brightness
+int PackedLumen::getBrightness() const {
+    return packed() ? narrow.brightness : wide.lumen->getBrightness();
+}
+
+// Preconditions: None
+// Postconditions: Returns the current power
+int PackedLumen::getPower() const {
+    return packed() ? narrow.power : wide.lumen->getPower();
+}
+
+// Preconditions: None
+// Postconditions: Returns the size
+int PackedLumen::getSize() const {
+    return packed() ? narrow.size : wide.lumen->getSize();
+}
+
+// Preconditions: None
+// Postconditions: Returns a Lumen with the same state, including the derived fields
+Lumen PackedLumen::toLumen() const {
+    if (!packed()) {
+        return *wide.lumen;
+    }
+    Lumen lumen(1, 1, 1);
+    lumen.brightness = narrow.brightness;
+    lumen.size = narrow.size;
+    lumen.power = narrow.power;
+    lumen.brightnessCopy = narrow.brightnessCopy;
+    lumen.powerCopy = narrow.powerCopy;
+    lumen.dimmingValue = dimmingValue();
+    lumen.powerThreshold = powerThreshold();
+    lumen.glowRequest = narrow.glowRequest;
+    lumen.maxReset = maxReset();
+    lumen.resetCount = narrow.resetCount;
+    lumen.charged = (narrow.flags & CHARGED) != 0;
+    return lumen;
+}
+
+// Preconditions: None
+// Postconditions: Returns true while the lumen is held in the 16-byte form
+bool PackedLumen::isPacked() const {
+    return packed();
+}
+
+/************************************ Helpers *****************************************************/
+
+int PackedLumen::dimmingValue() const {
+    return dimmingFor(narrow.brightnessCopy);
+}
+
+int PackedLumen::powerThreshold() const {
+    return thresholdFor(narrow.powerCopy);
+}
+
+int PackedLumen::maxReset() const {
+    return narrow.size * 3;
+}
+
+// Preconditions: None
+// Postconditions: Returns true if lumen can be held in the packed form without losing anything
+bool PackedLumen::fits(const Lumen& lumen) {
+    return narrowFits(lumen.brightness) && narrowFits(lumen.size) && narrowFits(lumen.power)
+        && narrowFits(lumen.brightnessCopy) && narrowFits(lumen.powerCopy)
+        && lumen.glowRequest >= 0 && lumen.glowRequest <= GLOWREQUESTMAX
+        && lumen.resetCount >= 0 && lumen.resetCount <= RESETCOUNTMAX
+        && lumen.dimmingValue == dimmingFor(lumen.brightnessCopy)
+        && lumen.powerThreshold == thresholdFor(lumen.powerCopy)
+        && static_cast<long long>(lumen.size) * 3 == lumen.maxReset;
+}
+
+// Preconditions: this holds no wide Lumen
+// Postconditions: this holds the state of lumen, packed if it fits
+void PackedLumen::store(const Lumen& lumen) {
+    if (!fits(lumen)) {
+        wide.lumen = new Lumen(lumen);
+        wide.flags = WIDE;
+        return;
+    }
+    narrow.flags = lumen.charged ? CHARGED : 0;
+    narrow.resetCount = static_cast<std::uint8_t>(lumen.resetCount);
+    narrow.brightness = static_cast<std::int16_t>(lumen.brightness);
+    narrow.size = static_cast<std::int16_t>(lumen.size);
+    narrow.power = static_cast<std::int16_t>(lumen.power);
+    narrow.brightnessCopy = static_cast<std::int16_t>(lumen.brightnessCopy);
+    narrow.powerCopy = static_cast<std::int16_t>(lumen.powerCopy);
+    narrow.glowRequest = static_cast<std::uint16_t>(lumen.glowRequest);
+}
+
+// Preconditions: this is packed
+// Postconditions: this holds the same state in the wide form
+void PackedLumen::promote() {
+    Lumen* lumen = new Lumen(toLumen());
+    wide.lumen = lumen;
+    wide.flags = WIDE;
+}
+
+// Preconditions: None
+// Postconditions: the wide Lumen, if any, is deleted
+void PackedLumen::release() {
+    if (!packed()) {
+        delete wide.lumen;
+    }
+}
+
+
+/*
+Implementation Invariant:
+- narrow.flags and wide.flags share the first byte of the object, so packed() is valid in
+  both forms.
+- Narrow fields are checked before every change that could leave their range; a change that
+  would overflow promotes the lumen first, so the packed form never wraps.
+- A moved-from PackedLumen is packed and owns nothing.
+*/
@@ -0,0 +1,99 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+PackedLumen.h is the header file for the PackedLumen class, a Lumen stored in 16 bytes instead
+of 44. The packed form keeps brightness, size, power and their originals as 16-bit values, the
+glow request count in 16 bits and the reset count in 8 bits, and recomputes dimmingValue,
+powerThreshold and maxReset from the originals instead of storing them.
+
+A Lumen whose values do not fit (large inputs, or a Lumen built with Lumen arithmetic whose
+derived fields no longer follow from its originals) is held in the wide form: a pointer to a
+heap Lumen. A packed lumen is promoted to the wide form the moment an operation would overflow
+one of its narrow fields, so every operation returns exactly what the same Lumen would return.
+*/
+
+#ifndef PACKED_LUMEN_H
+#define PACKED_LUMEN_H
+
+#include <cstdint>
+#include "lumen.h"
+
+class PackedLumen {
+public:
+    PackedLumen(int inputBrightness, int inputSize, int inputPower);
+    explicit PackedLumen(const Lumen& lumen);
+
+    PackedLumen(const PackedLumen& other);
+    PackedLumen(PackedLumen&& other) noexcept;
+    PackedLumen& operator=(const PackedLumen& other);
+    PackedLumen& operator=(PackedLumen&& other) noexcept;
+    ~PackedLumen();
+
+    int glow();
+    bool reset();
+    void recharge();
+
+    bool isActive() const;
+    bool isErratic() const;
+    int currentGlowValue() const;
+
+    int getBrightness() const;
+    int getPower() const;
+    int getSize() const;
+
+    Lumen toLumen() const; // the equivalent Lumen, with every field set
+    bool isPacked() const; // false once the lumen lives in the wide form
+
+private:
+    static constexpr std::uint8_t WIDE = 1;
+    static constexpr std::uint8_t CHARGED = 2;
+
+    // Both forms start with the flags byte, so it can be read whichever form is active
+    struct Narrow {
+        std::uint8_t flags;
+        std::uint8_t resetCount;
+        std::int16_t brightness;
+        std::int16_t size;
+        std::int16_t power;
+        std::int16_t brightnessCopy;
+        std::int16_t powerCopy;
+        std::uint16_t glowRequest;
+    };
+
+    struct Wide {
+        std::uint8_t flags;
+        Lumen* lumen;
+    };
+
+    union {
+        Narrow narrow;
+        Wide wide;
+    };
+
+    bool packed() const { return !(narrow.flags & WIDE); }
+    int dimmingValue() const;
+    int powerThreshold() const;
+    int maxReset() const;
+
+    static bool fits(const Lumen& lumen);
+    void store(const Lumen& lumen);
+    void promote();
+    void release();
+};
+
+#endif // PACKED_LUMEN_H
+
+
+/*
+Class invariants for PackedLumen:
+
+- sizeof(PackedLumen) is 16 bytes.
+- In the packed form, dimmingValue, powerThreshold and maxReset are exactly what the Lumen
+  constructor computes from brightnessCopy, powerCopy and size.
+- In the wide form, the PackedLumen owns its heap Lumen and never returns to the packed form.
+- Every operation returns and leaves behind the same values as the equivalent Lumen.
+*/
@@ -0,0 +1,218 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The PooledLuminosity class recycles Lumen storage. The shared arena owns the slabs and a global
+free list; every thread keeps a small cache of free slots per arena in thread-local storage.
+illuminate pops a slot from the cache (refilling it from the arena in batches) and constructs the
+Lumen in place; extinguish destroys the Lumen and pushes its slot onto the cache, handing half of
+the cache back to the arena once it grows too large.
+
+The factory is the only owner of its arena, so the slabs are freed with the factory. Thread
+caches only hold a weak reference: a cache whose arena is gone is forgotten without touching its
+slots, which went away with the slabs.
+
+ASSUMPTIONS:
+- Lumens are only given back through extinguish of the factory that created them.
+- Slabs are never returned to the system before the arena itself is destroyed.
+*/
+
+#include "pooled_luminosity.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+constexpr int CACHEBATCH = 64; // slots moved between a thread cache and the arena at once
+
+std::atomic<std::uint64_t> nextArenaId(1); // ids are never reused, unlike arena addresses
+
+union Slot {
+    Slot* next;
+    alignas(Lumen) unsigned char storage[sizeof(Lumen)];
+};
+
+} // namespace
+
+struct PooledLuminosity::Arena {
+    explicit Arena(int slabSize)
+    : id(nextArenaId.fetch_add(1, std::memory_order_relaxed)), slabSize(slabSize), carved(slabSize),
+      freeList(nullptr), freeCount(0) {}
+
+    std::uint64_t id;
+    int slabSize;
+    std::mutex lock;
+    std::vector<std::unique_ptr<Slot[]>> slabs;
+    int carved; // slots of the newest slab already handed out
+    Slot* freeList;
+    int freeCount;
+
+    // Pre-Condition: wanted is positive
+    // Post-Condition: returns a chain of up to wanted free slots and their number in got
+    Slot* take(int wanted, int& got) {
+        std::lock_guard<std::mutex> guard(lock);
+        Slot* head = nullptr;
+        got = 0;
+        while (got < wanted && freeList) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            freeCount--;
+            slot->next = head;
+            head = slot;
+            got++;
+        }
+        while (got < wanted) {
+            if (carved == slabSize) {
+                slabs.push_back(std::unique_ptr<Slot[]>(new Slot[slabSize]));
+                carved = 0;
+            }
+            Slot* slot = &slabs.back()[carved++];
+            slot->next = head;
+            head = slot;
+            got++;
+        }
+        return head;
+    }
+
+    // Pre-Condition: head is a chain of count free slots of this arena
+    // Post-Condition: the slots are on the arena's free list
+    void give(Slot* head, int count) {
+        if (!head) {
+            return;
+        }
+        Slot* tail = head;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        tail->next = freeList;
+        freeList = head;
+        freeCount += count;
+    }
+};
+
+namespace {
+
+struct ThreadCache {
+    std::uint64_t arenaId;
+    std::weak_ptr<PooledLuminosity::Arena> arena; // expired once the factory is destroyed
+    Slot* head; // dangling, and never followed, once arena has expired
+    int count;
+};
+
+struct ThreadCaches {
+    std::vector<ThreadCache> caches;
+
+    // Post-Condition: every cached slot of a live arena is returned to it when the thread exits
+    ~ThreadCaches() {
+        for (ThreadCache& cache : caches) {
+            if (std::shared_ptr<PooledLuminosity::Arena> arena = cache.arena.lock()) {
+                arena->give(cache.head, cache.count);
+            }
+        }
+    }
+
+    // Pre-Condition: arena is alive
+    // Post-Condition: returns this thread's cache for arena, creating it if needed
+    ThreadCache& cacheFor(const std::shared_ptr<PooledLuminosity::Arena>& arena) {
+        for (ThreadCache& cache : caches) {
+            if (cache.arenaId == arena->id) {
+                return cache;
+            }
+        }
+        // Drop caches of arenas whose factory is gone; their slots were freed with the slabs
+        caches.erase(std::remove_if(caches.begin(), caches.end(), [](const ThreadCache& cache) {
+            return cache.arena.expired();
+        }), caches.end());
+        caches.push_back(ThreadCache{arena->id, arena, nullptr, 0});
+        return caches.back();
+    }
+};
+
+thread_local ThreadCaches threadCaches;
+
+} // namespace
+
+// Pre-Condition: slabSize is positive
+// Post-Condition: a factory with an empty arena is created
+PooledLuminosity::PooledLuminosity(int slabSize)
+: arena(std::make_shared<Arena>(slabSize > 0 ? slabSize : 1)) {}
+
+// Pre-Condition: every Lumen of this factory has been extinguished and no other thread is using it
+// Post-Condition: the arena and all of its slabs are freed; thread caches of it are forgotten lazily
+PooledLuminosity::~PooledLuminosity() = default;
+
+// Pre-Condition: brightness, size, and power are positive
+// Post-Condition: returns a new Lumen constructed in a pooled slot
+Lumen* PooledLuminosity::illuminate(int brightness, int size, int power) {
+    ThreadCache& cache = threadCaches.cacheFor(arena);
+    if (!cache.head) {
+        cache.head = arena->take(CACHEBATCH, cache.count);
+    }
+    Slot* slot = cache.head;
+    cache.head = slot->next;
+    cache.count--;
+    try {
+        Lumen* lumen = new (slot->storage) Lumen(brightness, size, power);
+        NovaMetrics::add(NovaCounter::LumenAllocations);
+        return lumen;
+    } catch (...) {
+        slot->next = cache.head;
+        cache.head = slot;
+        cache.count++;
+        throw;
+    }
+}
+
+// Pre-Condition: lumen was returned by illuminate of this factory
+// Post-Condition: lumen is destroyed and its slot is free for reuse
+void PooledLuminosity::extinguish(Lumen* lumen) {
+    if (!lumen) {
+        return;
+    }
+    lumen->~Lumen();
+    NovaMetrics::add(NovaCounter::LumenFrees);
+    Slot* slot = reinterpret_cast<Slot*>(lumen);
+
+    ThreadCache& cache = threadCaches.cacheFor(arena);
+    slot->next = cache.head;
+    cache.head = slot;
+    cache.count++;
+
+    if (cache.count > 2 * CACHEBATCH) {
+        // keep CACHEBATCH slots, hand the rest back so other threads can use them
+        Slot* keepTail = cache.head;
+        for (int i = 1; i < CACHEBATCH; i++) {
+            keepTail = keepTail->next;
+        }
+        Slot* returned = keepTail->next;
+        keepTail->next = nullptr;
+        arena->give(returned, cache.count - CACHEBATCH);
+        cache.count = CACHEBATCH;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of slabs the arena has allocated
+int PooledLuminosity::getNumSlabs() const {
+    std::lock_guard<std::mutex> guard(arena->lock);
+    return static_cast<int>(arena->slabs.size());
+}
+
+
+/*
+Implementation Invariant:
+- A thread cache always holds exactly count slots chained through head.
+- Slot storage is suitably aligned and large enough for a Lumen, so a Lumen can be constructed
+  in place and its address converted back to its slot.
+- The factory holds the only shared_ptr to its arena, so its slabs are freed with it. Thread
+  caches hold a weak_ptr and only follow their slot chain while it can be locked; they are
+  matched by arena id, so a new arena at the address of a dead one never picks up stale slots.
+*/
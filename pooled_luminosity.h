@@ -0,0 +1,51 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+PooledLuminosity.h is the header file for the PooledLuminosity class, an ILuminosity factory
+that builds Lumens inside slabs of preallocated slots instead of calling new for each one.
+Extinguished Lumens go back to a free list owned by the calling thread, so a thread that keeps
+illuminating and extinguishing Lumens recycles the same few slots without taking a lock or
+calling malloc. Slots only move through the shared arena, under a lock, in batches.
+*/
+
+#ifndef POOLED_LUMINOSITY_H
+#define POOLED_LUMINOSITY_H
+
+#include <memory>
+#include "nova.h"
+
+class PooledLuminosity : public ILuminosity {
+public:
+    explicit PooledLuminosity(int slabSize = 1024);
+    ~PooledLuminosity() override;
+
+    PooledLuminosity(const PooledLuminosity&) = delete;
+    PooledLuminosity& operator=(const PooledLuminosity&) = delete;
+
+    Lumen* illuminate(int brightness, int size, int power) override;
+    void extinguish(Lumen* lumen) override;
+
+    int getNumSlabs() const; // slabs allocated so far
+
+    struct Arena;
+
+private:
+    std::shared_ptr<Arena> arena;
+};
+
+#endif // POOLED_LUMINOSITY_H
+
+
+/*
+Class invariants for PooledLuminosity:
+
+- Every Lumen returned by illuminate lives in a slot of one of the arena's slabs and must be
+  given back with extinguish of the same factory (from any thread).
+- A slot is either in use by exactly one Lumen, in exactly one free list, or not yet carved
+  out of the newest slab.
+- The arena and its slabs live exactly as long as the factory; thread caches never keep them.
+*/
@@ -0,0 +1,235 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+SmallVector.h holds the SmallVector class template, a growable array of trivially copyable
+items whose first N items live inside the object itself. The index arrays of a small lumen bank
+then cost no allocation at all; only growing past N moves the items to the heap, and from there
+the array grows geometrically like std::vector. It offers just the part of the std::vector
+interface the lumen indexes use.
+*/
+
+#ifndef SMALL_VECTOR_H
+#define SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+template <class T, int N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector moves its items with memcpy");
+    static_assert(N > 0, "SmallVector needs room for at least one inline item");
+
+public:
+    SmallVector();
+    ~SmallVector();
+    SmallVector(const SmallVector& other);
+    SmallVector(SmallVector&& other) noexcept;
+    SmallVector& operator=(const SmallVector& other);
+    SmallVector& operator=(SmallVector&& other) noexcept;
+
+    int size() const;
+    bool empty() const;
+    T* data();
+    const T* data() const;
+    T& operator[](int index);
+    const T& operator[](int index) const;
+
+    void push_back(const T& item);
+    void pop_back();
+    void clear(); // keeps the capacity
+    void resize(int n); // new items are value-initialized
+
+private:
+    T* items; // inlineItems, or a heap array of cap items
+    int count;
+    int cap;
+    T inlineItems[N];
+
+    void reserve(int newCapacity);
+    void release();
+};
+
+// Pre-Condition: None
+// Post-Condition: an empty vector using its inline items is created
+template <class T, int N>
+SmallVector<T, N>::SmallVector() : items(inlineItems), count(0), cap(N) {}
+
+// Pre-Condition: None
+// Post-Condition: a heap array, if any, is freed
+template <class T, int N>
+SmallVector<T, N>::~SmallVector() {
+    release();
+}
+
+// Pre-Condition: None
+// Post-Condition: the vector holds copies of other's items
+template <class T, int N>
+SmallVector<T, N>::SmallVector(const SmallVector& other) : SmallVector() {
+    *this = other;
+}
+
+// Pre-Condition: None
+// Post-Condition: the vector holds other's items and other is empty
+template <class T, int N>
+SmallVector<T, N>::SmallVector(SmallVector&& other) noexcept : SmallVector() {
+    *this = std::move(other);
+}
+
+// Pre-Condition: None
+// Post-Condition: the vector holds copies of other's items
+template <class T, int N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& other) {
+    if (this != &other) {
+        count = 0;
+        reserve(other.count);
+        std::memcpy(items, other.items, sizeof(T) * other.count);
+        count = other.count;
+    }
+    return *this;
+}
+
+// Pre-Condition: None
+// Post-Condition: the vector holds other's items and other is empty; a heap array changes
+//                 owner, inline items are copied
+template <class T, int N>
+SmallVector<T, N>& SmallVector<T, N>::operator=(SmallVector&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+    if (other.items == other.inlineItems) {
+        std::memcpy(items, other.items, sizeof(T) * other.count); // fits: cap >= N
+    } else {
+        release();
+        items = other.items;
+        cap = other.cap;
+        other.items = other.inlineItems;
+        other.cap = N;
+    }
+    count = other.count;
+    other.count = 0;
+    return *this;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of items
+template <class T, int N>
+int SmallVector<T, N>::size() const {
+    return count;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the vector holds no items
+template <class T, int N>
+bool SmallVector<T, N>::empty() const {
+    return count == 0;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the first item, valid until the vector grows or is moved
+template <class T, int N>
+T* SmallVector<T, N>::data() {
+    return items;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the first item, valid until the vector grows or is moved
+template <class T, int N>
+const T* SmallVector<T, N>::data() const {
+    return items;
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns item index
+template <class T, int N>
+T& SmallVector<T, N>::operator[](int index) {
+    return items[index];
+}
+
+// Pre-Condition: 0 <= index < size()
+// Post-Condition: Returns item index
+template <class T, int N>
+const T& SmallVector<T, N>::operator[](int index) const {
+    return items[index];
+}
+
+// Pre-Condition: None
+// Post-Condition: item is stored as the new last item
+template <class T, int N>
+void SmallVector<T, N>::push_back(const T& item) {
+    if (count == cap) {
+        T copy = item; // item may be one of the items moved by the growth
+        reserve(cap * 2);
+        items[count++] = copy;
+        return;
+    }
+    items[count++] = item;
+}
+
+// Pre-Condition: the vector is not empty
+// Post-Condition: the last item is dropped
+template <class T, int N>
+void SmallVector<T, N>::pop_back() {
+    count--;
+}
+
+// Pre-Condition: None
+// Post-Condition: the vector is empty; its capacity is kept
+template <class T, int N>
+void SmallVector<T, N>::clear() {
+    count = 0;
+}
+
+// Pre-Condition: n is non-negative
+// Post-Condition: the vector holds n items; the first min(n, size()) are unchanged
+template <class T, int N>
+void SmallVector<T, N>::resize(int n) {
+    reserve(n);
+    if (n > count) {
+        std::fill(items + count, items + n, T());
+    }
+    count = n;
+}
+
+// Pre-Condition: newCapacity is non-negative
+// Post-Condition: cap >= newCapacity and the items are unchanged
+template <class T, int N>
+void SmallVector<T, N>::reserve(int newCapacity) {
+    if (newCapacity <= cap) {
+        return;
+    }
+    newCapacity = std::max(newCapacity, cap * 2);
+    T* grown = new T[newCapacity];
+    std::memcpy(grown, items, sizeof(T) * count);
+    release();
+    items = grown;
+    cap = newCapacity;
+}
+
+// Pre-Condition: None
+// Post-Condition: a heap array, if any, is freed and the vector uses its inline items again;
+//                 count is left as it was
+template <class T, int N>
+void SmallVector<T, N>::release() {
+    if (items != inlineItems) {
+        delete[] items;
+        items = inlineItems;
+        cap = N;
+    }
+}
+
+#endif // SMALL_VECTOR_H
+
+
+/*
+Class invariants for SmallVector:
+
+- 0 <= count <= cap; items == inlineItems exactly when cap == N, otherwise items is a heap
+  array of cap items owned by the vector.
+- items[0, count) are the items of the vector, in order.
+*/
@@ -0,0 +1,186 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The StateIndex class moves an id between neighbouring buckets by swapping it with the id at the
+shared border and shifting the border by one; a move between the active and the dimmed bucket
+is two such steps. Walking a bucket from its last id down to its first stays valid while the
+visited ids are moved out of it, since a move only swaps with ids at the far border that have
+already been visited.
+
+ASSUMPTIONS:
+- Ids are the dense lumen indices of one LumenBank.
+*/
+
+#include "state_index.h"
+#include <stdexcept>
+
+// Pre-Condition: first <= last, both inside the same array
+// Post-Condition: a view of the ids in [first, last) is created
+LumenIdRange::LumenIdRange(const int* first, const int* last) : first(first), last(last) {}
+
+// Pre-Condition: None
+// Post-Condition: Returns a pointer to the first id
+const int* LumenIdRange::begin() const {
+    return first;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns a pointer past the last id
+const int* LumenIdRange::end() const {
+    return last;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of ids in the range
+int LumenIdRange::size() const {
+    return static_cast<int>(last - first);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if the range holds no ids
+bool LumenIdRange::empty() const {
+    return first == last;
+}
+
+// Pre-Condition: None
+// Post-Condition: an empty index is created
+StateIndex::StateIndex() : ends{0, 0, 0} {}
+
+// Pre-Condition: None
+// Post-Condition: id size() is added in the bucket of state
+void StateIndex::add(LumenState state) {
+    int id = size();
+    order.push_back(id);
+    slot.push_back(id);
+    ends[2]++;
+    move(id, state);
+}
+
+// Pre-Condition: the index is not empty
+// Post-Condition: the id size() - 1 is no longer indexed
+void StateIndex::removeLast() {
+    if (order.empty()) {
+        throw std::logic_error("StateIndex has no id to remove.");
+    }
+    int id = size() - 1;
+    move(id, LumenState::Dimmed);
+    swapSlots(slot[id], size() - 1);
+    order.pop_back();
+    slot.pop_back();
+    ends[2]--;
+}
+
+// Pre-Condition: 0 <= id < size()
+// Post-Condition: id is in the bucket of state
+void StateIndex::move(int id, LumenState state) {
+    int from = static_cast<int>(stateOf(id));
+    int to = static_cast<int>(state);
+    // towards the dimmed end: swap with the last id of the bucket and give up that slot
+    while (from < to) {
+        swapSlots(slot[id], ends[from] - 1);
+        ends[from]--;
+        from++;
+    }
+    // towards the active end: swap with the first id of the bucket and join the one before
+    while (from > to) {
+        swapSlots(slot[id], ends[from - 1]);
+        ends[from - 1]++;
+        from--;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: no id is indexed
+void StateIndex::clear() {
+    order.clear();
+    slot.clear();
+    ends[0] = ends[1] = ends[2] = 0;
+}
+
+// Pre-Condition: states holds n states
+// Post-Condition: the index holds ids 0 .. n - 1, id i in the bucket of states[i]
+void StateIndex::assign(const LumenState* states, int n) {
+    int counts[3] = {0, 0, 0};
+    for (int i = 0; i < n; i++) {
+        counts[static_cast<int>(states[i])]++;
+    }
+    ends[0] = counts[0];
+    ends[1] = ends[0] + counts[1];
+    ends[2] = ends[1] + counts[2];
+
+    // every bucket lists its ids in increasing order
+    order.resize(n);
+    slot.resize(n);
+    int next[3] = {0, ends[0], ends[1]};
+    for (int i = 0; i < n; i++) {
+        int position = next[static_cast<int>(states[i])]++;
+        order[position] = i;
+        slot[i] = position;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of indexed ids
+int StateIndex::size() const {
+    return static_cast<int>(order.size());
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the number of ids in the bucket of state, O(1)
+int StateIndex::count(LumenState state) const {
+    int s = static_cast<int>(state);
+    return ends[s] - bucketBegin(s);
+}
+
+// Pre-Condition: 0 <= id < size()
+// Post-Condition: Returns the state whose bucket holds id
+LumenState StateIndex::stateOf(int id) const {
+    int position = slot[id];
+    if (position < ends[0]) {
+        return LumenState::Active;
+    }
+    return position < ends[1] ? LumenState::Erratic : LumenState::Dimmed;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the ids in the bucket of state
+LumenIdRange StateIndex::ids(LumenState state) const {
+    int s = static_cast<int>(state);
+    return LumenIdRange(order.data() + bucketBegin(s), order.data() + ends[s]);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns the ids of every erratic and dimmed lumen
+LumenIdRange StateIndex::inactiveIds() const {
+    return LumenIdRange(order.data() + ends[0], order.data() + ends[2]);
+}
+
+// Pre-Condition: 0 <= s < 3
+// Post-Condition: Returns the position of the first id in the bucket of state s
+int StateIndex::bucketBegin(int s) const {
+    return s == 0 ? 0 : ends[s - 1];
+}
+
+// Pre-Condition: 0 <= a, b < size()
+// Post-Condition: the ids at positions a and b have traded places
+void StateIndex::swapSlots(int a, int b) {
+    int idA = order[a];
+    int idB = order[b];
+    order[a] = idB;
+    order[b] = idA;
+    slot[idB] = a;
+    slot[idA] = b;
+}
+
+
+/*
+Implementation Invariant:
+- move() only ever shifts a border by one slot and swaps across it, so every bucket stays
+  contiguous and the buckets keep their order.
+- add() appends to the dimmed bucket, which is the last one, and removeLast() takes the id out
+  of the last slot after moving it there, so the other buckets never shift.
+*/
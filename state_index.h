@@ -0,0 +1,78 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+StateIndex.h is the header file for the StateIndex class, which partitions the ids of a group of
+lumens (0 .. size() - 1) by LumenState. The ids are kept in one array with the active ids first,
+then the erratic ones, then the dimmed ones, and every id knows its slot in that array. Moving a
+lumen to another state is at most two swaps at the bucket borders, so it costs O(1); the size of
+every bucket is O(1) and each bucket can be walked directly.
+
+LumenIdRange is a view of the ids of one bucket (or of the erratic and dimmed buckets together,
+which sit next to each other). It is only valid until the next change of the index.
+*/
+
+#ifndef STATE_INDEX_H
+#define STATE_INDEX_H
+
+#include "glow_kernels.h"
+#include "small_vector.h"
+
+class LumenIdRange {
+public:
+    LumenIdRange(const int* first, const int* last);
+
+    const int* begin() const;
+    const int* end() const;
+    int size() const;
+    bool empty() const;
+
+private:
+    const int* first;
+    const int* last;
+};
+
+class StateIndex {
+public:
+    StateIndex();
+
+    void add(LumenState state); // the new id is the old size()
+    void removeLast(); // drops the id size() - 1
+    void move(int id, LumenState state);
+    void clear();
+    void assign(const LumenState* states, int n); // ids 0 .. n - 1 in states[0 .. n - 1]
+
+    int size() const;
+    int count(LumenState state) const;
+    LumenState stateOf(int id) const;
+    LumenIdRange ids(LumenState state) const; // ids in the bucket of state
+    LumenIdRange inactiveIds() const; // the erratic and the dimmed bucket together
+
+private:
+    static constexpr int INLINEIDS = 16; // ids held without allocating, as many as an inline LumenBank holds
+
+    SmallVector<int, INLINEIDS> order; // ids grouped by state: active, erratic, dimmed
+    SmallVector<int, INLINEIDS> slot; // slot[id] = position of id in order
+    int ends[3]; // the bucket of state s ends at ends[s] (exclusive)
+
+    int bucketBegin(int s) const;
+    void swapSlots(int a, int b);
+};
+
+#endif // STATE_INDEX_H
+
+
+/*
+Class invariants for StateIndex:
+
+- order and slot have size() entries and are inverse permutations of 0 .. size() - 1.
+- 0 <= ends[0] <= ends[1] <= ends[2] == size(); order[0, ends[0]) holds the active ids,
+  order[ends[0], ends[1]) the erratic ones and order[ends[1], ends[2]) the dimmed ones.
+
+Class invariants for LumenIdRange:
+
+- [first, last) lies inside the order array of a StateIndex that has not changed since.
+*/
@@ -1,60 +1,980 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The test program for the Lumen and Nova classes (the nova_tests target, run by ctest). Every
+optimized path is checked against ReferenceNova, a plain vector<Lumen> that glows and recharges
+exactly as the original Nova did, one Lumen at a time:
+- glow, lumen operations, counts and min/max glow, under every glow kernel set this CPU supports,
+  with the SIMD kernel sets bit-exact with the scalar one
+- glowTicks(x, k) against k calls of glow(x)
+- parallel glow against sequential glow
+- NovaScheduler against glow()
+- snapshot round trips of a Lumen, a Nova and a fleet, including lumens built with Lumen arithmetic
+- NovaView reads of a FleetImage against the reference, where fleet images exist (NOVA_FLEET_IMAGE)
+- PackedLumen against Lumen
+- FixedNova and LazyNova against the reference
+- PooledLuminosity against Luminosity and the reference, and its reuse of extinguished slots
+- the Nova comparison operators
+- Nova + Nova and Nova - Nova chains against summed Lumen values, and the comparisons and queries
+  of an expression against the Nova it converts to
+- glowStats, glowPercentile and the fleet statistics of NovaEngine against sorted glow values
+- topK and bottomK against the sorted glow values, as lumens are added and dropped
+- append(Nova&&) into an empty and a non-empty Nova against the concatenated reference
+- every NovaMetrics counter against the transitions, recharges and reset outcomes of the reference
+
+Lumens are compared field by field through their Lumen snapshot bytes, so every field counts,
+private ones included. The program prints each failed check and returns the number of failures.
+
+ASSUMPTIONS:
+- The random inputs keep every glow value within int: brightness * size * (power + 10) never
+  overflows for the sizes used here, in the reference or in the Nova.
+- Kernel sets the CPU lacks are skipped, not failed.
+- The temporary directory is writable, for the fleet image.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
-#include "lumen.h"
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "fixed_nova.h"
+#include "glow_kernels.h"
+#include "lazy_nova.h"
 #include "nova.h"
+#include "nova_engine.h"
+#include "nova_metrics.h"
+#include "nova_scheduler.h"
+#include "nova_snapshot.h"
+#include "nova_view.h"
+#include "packed_lumen.h"
+#include "pooled_luminosity.h"
+#include "work_stealing_pool.h"
+
 using namespace std;
-int main() {
-    // Create two Nova objects with same properties
-    Nova nova1(5, 10, 20, 3);
-    Nova nova2(5, 10, 20, 3);
 
-    // Test equality
-    if (nova1 == nova2) {
-        std::cout << "Nova1 and Nova2 are equal" << std::endl;
-    } else {
-        std::cout << "Nova1 and Nova2 are not equal" << std::endl;
+namespace {
+
+const char* const KERNELSETS[] = {"scalar", "sse4.2", "avx2", "avx512"};
+const int NUMSCENARIOS = 300; // random Novas per kernel set
+const int MAXLUMENS = 600; // keeps erratic glow values within int, see ASSUMPTIONS
+const int PARALLELLUMENS = 40000; // enough for parallel glow to split into chunks
+
+int failures = 0;
+mt19937 rng(3200);
+Luminosity luminate;
+
+// Pre-Condition: None
+// Post-Condition: a failed check is counted and reported
+void check(bool ok, const string& what) {
+    if (!ok) {
+        failures++;
+        std::cout << "FAILED: " << what << std::endl;
+    }
+}
+
+// Pre-Condition: low <= high
+// Post-Condition: Returns a random value in [low, high]
+int randomInt(int low, int high) {
+    return uniform_int_distribution<int>(low, high)(rng);
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns every field of lumen, as its snapshot bytes
+string stateOf(const Lumen& lumen) {
+    ostringstream out;
+    NovaSnapshot::write(out, lumen);
+    return out.str();
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns every field of every lumen of nova, as its snapshot bytes
+string stateOf(const Nova& nova) {
+    ostringstream out;
+    NovaSnapshot::write(out, nova);
+    return out.str();
+}
+
+// A factory whose lumens are built with Lumen arithmetic, so their derived fields (dimmingValue,
+// powerThreshold, maxReset, ...) no longer follow from brightness, size and power
+class ShiftedLuminosity : public ILuminosity {
+public:
+    Lumen* illuminate(int brightness, int size, int power) override {
+        return new Lumen(Lumen(brightness, size, power) + 1);
+    }
+};
+
+// The original Nova: an array of Lumens, glowed and recharged one at a time
+class ReferenceNova {
+public:
+    // Pre-Condition: initial values and numLumens are positive
+    // Post-Condition: lumen i is Lumen(brightness + i, size + i, power + i * 10), as in Nova
+    ReferenceNova(int initialBrightness, int initialSize, int initialPower, int numLumens) {
+        for (int i = 0; i < numLumens; i++) {
+            lumens.emplace_back(initialBrightness + i, initialSize + i, initialPower + i * 10);
+        }
+    }
+
+    // Pre-Condition: 0 <= x <= size
+    // Post-Condition: the first x lumens glow, then the stable ones recharge if more than half
+    //                 of the lumens are inactive
+    void glow(int x) {
+        for (int i = 0; i < x; i++) {
+            lumens[i].glow();
+        }
+        int inactive = 0;
+        for (Lumen& lumen : lumens) {
+            inactive += !lumen.isActive();
+        }
+        if (inactive > static_cast<int>(lumens.size()) / 2) {
+            rechargeRounds++;
+            for (Lumen& lumen : lumens) {
+                if (!lumen.isErratic() && lumen.isActive()) {
+                    lumen.recharge();
+                }
+            }
+        }
+    }
+
+    vector<Lumen> lumens;
+    int rechargeRounds = 0; // glows that recharged the stable lumens
+};
+
+// Pre-Condition: None
+// Post-Condition: Returns true if every lumen, count and min/max glow of nova matches reference
+bool matches(Nova& nova, ReferenceNova& reference) {
+    int n = static_cast<int>(reference.lumens.size());
+    if (nova.getNumLumens() != n) {
+        return false;
+    }
+    int active = 0;
+    int erratic = 0;
+    for (int i = 0; i < n; i++) {
+        Lumen& lumen = reference.lumens[i];
+        if (stateOf(nova.lumen(i).toLumen()) != stateOf(lumen)
+            || nova.currentGlowValue(i) != lumen.currentGlowValue()) {
+            return false;
+        }
+        active += lumen.isActive();
+        erratic += lumen.isErratic();
+    }
+    if (nova.getNumActiveLumens() != active || nova.getNumErraticLumens() != erratic
+        || nova.getNumInactiveLumens() != n - active) {
+        return false;
+    }
+    if (n == 0) {
+        return true;
+    }
+    int minValue = reference.lumens[0].currentGlowValue();
+    int maxValue = minValue;
+    for (Lumen& lumen : reference.lumens) {
+        minValue = min(minValue, lumen.currentGlowValue());
+        maxValue = max(maxValue, lumen.currentGlowValue());
+    }
+    return nova.minGlow() == minValue && nova.maxGlow() == maxValue;
+}
+
+// Pre-Condition: nova and reference hold the same lumens
+// Post-Condition: both went through the same random mix of glows and lumen operations
+void scramble(Nova& nova, ReferenceNova& reference, int steps) {
+    int n = nova.getNumLumens();
+    for (int step = 0; step < steps; step++) {
+        int op = randomInt(0, 9);
+        int i = randomInt(0, n - 1);
+        if (op == 0) {
+            nova.lumen(i).glow();
+            reference.lumens[i].glow();
+        } else if (op == 1) {
+            check(nova.lumen(i).reset() == reference.lumens[i].reset(), "lumen reset result");
+        } else if (op == 2) {
+            nova.lumen(i).recharge();
+            reference.lumens[i].recharge();
+        } else {
+            int x = randomInt(0, n);
+            nova.glow(x);
+            reference.glow(x);
+        }
+    }
+}
+
+// Pre-Condition: the current kernel set is kernelSet
+// Post-Condition: glow, glowTicks and the scheduler are checked against the reference; returns
+//                 the state of every Nova built, for comparing kernel sets with each other
+string checkGlowPaths(const string& kernelSet) {
+    string states;
+    for (int scenario = 0; scenario < NUMSCENARIOS; scenario++) {
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS);
+        string where = kernelSet + " scenario " + to_string(scenario);
+
+        Nova nova(&luminate, brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        scramble(nova, reference, randomInt(0, 40));
+        check(matches(nova, reference), where + ": glow matches the reference");
+
+        int x = randomInt(0, n);
+        int ticks = randomInt(0, 200);
+        ReferenceNova ticked = reference;
+        for (int t = 0; t < ticks; t++) {
+            ticked.glow(x);
+        }
+        Nova glowed(nova);
+        for (int t = 0; t < ticks; t++) {
+            glowed.glow(x);
+        }
+        check(matches(glowed, ticked), where + ": repeated glow matches the reference");
+
+        Nova skipped(nova);
+        skipped.glowTicks(x, ticks);
+        check(stateOf(skipped) == stateOf(glowed) && matches(skipped, ticked),
+              where + ": glowTicks(x, k) matches k calls of glow(x)");
+
+        Nova scheduled(nova);
+        {
+            NovaScheduler scheduler(scheduled, x);
+            int firstTicks = randomInt(0, ticks);
+            scheduler.tick(firstTicks);
+            scheduler.flush();
+            scheduler.tick(ticks - firstTicks);
+        }
+        check(stateOf(scheduled) == stateOf(glowed) && matches(scheduled, ticked),
+              where + ": NovaScheduler matches glow()");
+
+        states += stateOf(glowed);
+    }
+    return states;
+}
+
+// Pre-Condition: the current kernel set is kernelSet
+// Post-Condition: parallel glow is checked against sequential glow and the reference
+void checkParallelGlow(const string& kernelSet, WorkStealingPool& pool) {
+    // small brightness and size: only the first few lumens ever become erratic, so every glow
+    // value stays within int
+    Nova parallel(&luminate, randomInt(1, 5), randomInt(1, 5), randomInt(1, 30), PARALLELLUMENS);
+    Nova sequential(parallel);
+    ReferenceNova reference(1, 1, 1, 0);
+    for (int i = 0; i < PARALLELLUMENS; i++) {
+        reference.lumens.push_back(parallel.lumen(i).toLumen());
+    }
+    parallel.parallelGlow(&pool, 0);
+    for (int t = 0; t < 40; t++) {
+        int x = randomInt(0, 3) == 0 ? randomInt(0, PARALLELLUMENS) : PARALLELLUMENS - randomInt(0, 50);
+        parallel.glow(x);
+        sequential.glow(x);
+        reference.glow(x);
+    }
+    check(stateOf(parallel) == stateOf(sequential) && matches(parallel, reference),
+          kernelSet + ": parallel glow matches sequential glow");
+}
+
+// Pre-Condition: None
+// Post-Condition: every supported kernel set is checked, and the SIMD ones against scalar; the
+//                 kernel set in use beforehand is restored
+void checkKernelSets() {
+    string detected = glowKernels().name;
+    WorkStealingPool pool(4);
+    string scalarStates;
+    for (const char* kernelSet : KERNELSETS) {
+        if (!useGlowKernels(kernelSet)) {
+            std::cout << "skipped kernel set " << kernelSet << " (not supported by this CPU)" << std::endl;
+            continue;
+        }
+        rng.seed(3200); // every kernel set runs the same scenarios
+        string states = checkGlowPaths(kernelSet);
+        if (scalarStates.empty()) {
+            scalarStates = states;
+        } else {
+            check(states == scalarStates, string(kernelSet) + ": bit-exact with the scalar kernels");
+        }
+        checkParallelGlow(kernelSet, pool);
+        std::cout << "checked kernel set " << kernelSet << std::endl;
+    }
+    useGlowKernels(detected.c_str());
+}
+
+// Pre-Condition: None
+// Post-Condition: Lumen, Nova and fleet snapshots are checked to restore every field
+void checkSnapshots() {
+    for (int scenario = 0; scenario < 100; scenario++) {
+        string where = "snapshot scenario " + to_string(scenario);
+        int n = randomInt(1, MAXLUMENS);
+        Nova nova(&luminate, randomInt(1, 50), randomInt(1, 5), randomInt(1, 60), n);
+        ReferenceNova reference(1, 1, 1, 0);
+        for (int i = 0; i < n; i++) {
+            reference.lumens.push_back(nova.lumen(i).toLumen());
+        }
+        scramble(nova, reference, randomInt(0, 60));
+
+        stringstream lumenSnapshot;
+        Lumen& lumen = reference.lumens[randomInt(0, n - 1)];
+        NovaSnapshot::write(lumenSnapshot, lumen);
+        check(stateOf(NovaSnapshot::readLumen(lumenSnapshot)) == stateOf(lumen), where + ": Lumen round trip");
+
+        stringstream novaSnapshot;
+        NovaSnapshot::write(novaSnapshot, nova);
+        Nova restored = NovaSnapshot::readNova(novaSnapshot, &luminate);
+        check(matches(restored, reference), where + ": Nova round trip");
+        restored.glow(n);
+        reference.glow(n);
+        check(matches(restored, reference), where + ": restored Nova keeps glowing like the original");
+    }
+
+    vector<unique_ptr<Nova>> fleet;
+    fleet.push_back(make_unique<Nova>(&luminate, 10, 2, 50, 5));
+    fleet.push_back(nullptr);
+    fleet.push_back(make_unique<Nova>(&luminate, 20, 3, 60, 40));
+    fleet[2]->glow(30);
+    stringstream fleetSnapshot;
+    NovaSnapshot::write(fleetSnapshot, fleet);
+    vector<unique_ptr<Nova>> restored = NovaSnapshot::readFleet(fleetSnapshot, &luminate);
+    check(restored.size() == fleet.size() && !restored[1] && stateOf(*restored[0]) == stateOf(*fleet[0])
+          && stateOf(*restored[2]) == stateOf(*fleet[2]), "fleet round trip");
+
+    Lumen shifted = Lumen(10, 2, 30) + 1;
+    stringstream shiftedSnapshot(stateOf(shifted));
+    check(stateOf(NovaSnapshot::readLumen(shiftedSnapshot)) == stateOf(shifted),
+          "a Lumen built with Lumen arithmetic survives a round trip");
+    ShiftedLuminosity shiftedLuminosity;
+    Nova shiftedNova(&shiftedLuminosity, 10, 2, 30, 20);
+    shiftedNova.glow(15);
+    stringstream shiftedNovaSnapshot(stateOf(shiftedNova));
+    Nova restoredShifted = NovaSnapshot::readNova(shiftedNovaSnapshot, &shiftedLuminosity);
+    check(stateOf(restoredShifted) == stateOf(shiftedNova)
+          && restoredShifted.minGlow() == shiftedNova.minGlow() && restoredShifted.maxGlow() == shiftedNova.maxGlow()
+          && restoredShifted.getNumActiveLumens() == shiftedNova.getNumActiveLumens(),
+          "a Nova of lumens built with Lumen arithmetic survives a round trip");
+
+    stringstream truncated(stateOf(*fleet[2]).substr(0, 40));
+    bool threw = false;
+    try {
+        NovaSnapshot::readNova(truncated, &luminate);
+    } catch (const runtime_error&) {
+        threw = true;
+    }
+    check(threw, "a truncated snapshot is rejected");
+}
+
+// Pre-Condition: None
+// Post-Condition: PackedLumen is checked to glow, reset and recharge exactly like Lumen
+void checkPackedLumen() {
+    for (int scenario = 0; scenario < 5000; scenario++) {
+        // small values stay packed; one large field takes the wide form without overflowing a
+        // glow value
+        int wide = randomInt(0, 3);
+        int brightness = randomInt(1, wide == 1 ? 40000 : 100);
+        int size = randomInt(1, wide == 2 ? 40000 : 10);
+        int power = randomInt(1, wide == 3 ? 40000 : 50);
+        Lumen lumen(brightness, size, power);
+        PackedLumen packed(brightness, size, power);
+        bool same = true;
+        for (int step = randomInt(0, 300); step > 0 && same; step--) {
+            int op = randomInt(0, 5);
+            if (op <= 2) {
+                same = lumen.glow() == packed.glow();
+            } else if (op == 3) {
+                same = lumen.reset() == packed.reset();
+            } else if (op == 4) {
+                lumen.recharge();
+                packed.recharge();
+            } else {
+                PackedLumen copy(packed);
+                packed = copy;
+            }
+        }
+        check(same && stateOf(packed.toLumen()) == stateOf(lumen),
+              "PackedLumen scenario " + to_string(scenario) + " matches Lumen");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: FixedNova is checked against the reference and its Nova conversions
+void checkFixedNova() {
+    const int N = 7;
+    for (int scenario = 0; scenario < 1000; scenario++) {
+        int brightness = randomInt(1, 30);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 40);
+        FixedNova<N> fixed(brightness, size, power);
+        ReferenceNova reference(brightness, size, power, N);
+        for (int t = randomInt(0, 60); t > 0; t--) {
+            int x = randomInt(0, N);
+            fixed.glow(x);
+            reference.glow(x);
+            if (randomInt(0, 5) == 0) {
+                int i = randomInt(0, N - 1);
+                fixed.lumen(i).reset();
+                reference.lumens[i].reset();
+            }
+        }
+        Nova nova = fixed.toNova(&luminate);
+        check(matches(nova, reference) && fixed.minGlow() == nova.minGlow() && fixed.maxGlow() == nova.maxGlow()
+              && fixed.getNumActiveLumens() == nova.getNumActiveLumens()
+              && fixed.getNumErraticLumens() == nova.getNumErraticLumens(),
+              "FixedNova scenario " + to_string(scenario) + " matches the reference");
+        FixedNova<N> back(nova);
+        check(stateOf(back.toNova(&luminate)) == stateOf(nova), "FixedNova round trip through Nova");
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: LazyNova is checked against the reference, before and after storing every lumen
+void checkLazyNova() {
+    for (int scenario = 0; scenario < 500; scenario++) {
+        int brightness = randomInt(1, 30);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 40);
+        int n = randomInt(1, 300);
+        LazyNova lazy(brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        for (int t = randomInt(0, 60); t > 0; t--) {
+            int op = randomInt(0, 4);
+            int i = randomInt(0, n - 1);
+            if (op <= 1) {
+                int x = randomInt(0, randomInt(0, 1) ? n : min(n, 10));
+                lazy.glow(x);
+                reference.glow(x);
+            } else if (op == 2) {
+                check(lazy.glowLumen(i) == reference.lumens[i].glow(), "LazyNova glowLumen result");
+            } else if (op == 3) {
+                check(lazy.resetLumen(i) == reference.lumens[i].reset(), "LazyNova resetLumen result");
+            } else {
+                lazy.rechargeLumen(i);
+                reference.lumens[i].recharge();
+            }
+        }
+        bool same = true;
+        for (int i = 0; i < n && same; i++) {
+            same = lazy.currentGlowValue(i) == reference.lumens[i].currentGlowValue();
+        }
+        Nova nova = lazy.toNova(&luminate);
+        check(same && matches(nova, reference) && lazy.minGlow() == nova.minGlow()
+              && lazy.maxGlow() == nova.maxGlow() && lazy.getNumActiveLumens() == nova.getNumActiveLumens()
+              && lazy.getNumErraticLumens() == nova.getNumErraticLumens(),
+              "LazyNova scenario " + to_string(scenario) + " matches the reference");
+    }
+}
+
+#ifdef NOVA_FLEET_IMAGE
+// Pre-Condition: the temporary directory is writable
+// Post-Condition: a fleet image of scrambled Novas, an empty Nova and an empty entry is checked
+//                 against the references through NovaView, before and after moving the image;
+//                 a truncated image is rejected
+void checkFleetImage() {
+    vector<unique_ptr<Nova>> fleet;
+    vector<ReferenceNova> references;
+    for (int scenario = 0; scenario < 30; scenario++) {
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS);
+        fleet.push_back(make_unique<Nova>(&luminate, brightness, size, power, n));
+        references.emplace_back(brightness, size, power, n);
+        scramble(*fleet.back(), references.back(), randomInt(0, 40));
+    }
+    fleet.push_back(nullptr);
+    references.emplace_back(1, 1, 1, 0);
+    fleet.push_back(make_unique<Nova>(&luminate, 5, 1, 5, 3));
+    fleet.back()->releaseLumens();
+    references.emplace_back(1, 1, 1, 0);
+
+    string path = (filesystem::temp_directory_path() / "nova_tests_fleet.img").string();
+    FleetImage::write(path, fleet);
+    FleetImage opened(path);
+    FleetImage image(std::move(opened)); // a moved image keeps its mapping
+    check(image.size() == static_cast<int>(fleet.size()), "the fleet image lists every entry");
+    for (int f = 0; f < image.size(); f++) {
+        string where = "fleet image entry " + to_string(f);
+        if (!fleet[f]) {
+            check(!image.hasNova(f), where + ": an empty entry holds no Nova");
+            continue;
+        }
+        NovaView view = image.nova(f);
+        ReferenceNova& reference = references[f];
+        int n = static_cast<int>(reference.lumens.size());
+        bool same = image.hasNova(f) && view.getNumLumens() == n;
+        int minValue = n > 0 ? reference.lumens[0].currentGlowValue() : 0;
+        int maxValue = minValue;
+        for (int i = 0; i < n && same; i++) {
+            int value = reference.lumens[i].currentGlowValue();
+            same = view.currentGlowValue(i) == value;
+            minValue = min(minValue, value);
+            maxValue = max(maxValue, value);
+        }
+        if (same && n > 0) {
+            same = view.minGlow() == minValue && view.maxGlow() == maxValue;
+        }
+        check(same, where + ": the view reads the glow values of the reference");
+    }
+
+    filesystem::resize_file(path, filesystem::file_size(path) / 2);
+    bool threw = false;
+    try {
+        FleetImage truncated(path);
+    } catch (const runtime_error&) {
+        threw = true;
+    }
+    check(threw, "a truncated fleet image is rejected");
+    filesystem::remove(path);
+}
+#endif // NOVA_FLEET_IMAGE
+
+// Pre-Condition: None
+// Post-Condition: PooledLuminosity is checked to build the same Lumens and Novas as Luminosity, to
+//                 reuse extinguished slots instead of growing, and to take back Lumens from
+//                 another thread
+void checkPooledLuminosity() {
+    PooledLuminosity pooled(16); // small slabs, so the Novas below span many of them
+    for (int scenario = 0; scenario < 50; scenario++) {
+        string where = "pooled scenario " + to_string(scenario);
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS);
+        Nova nova(&pooled, brightness, size, power, n);
+        Nova plain(&luminate, brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        check(stateOf(nova) == stateOf(plain), where + ": pooled lumens equal the ones Luminosity builds");
+        scramble(nova, reference, randomInt(0, 40));
+        int count = randomInt(0, 20);
+        nova += count;
+        for (int i = 0; i < count; i++) {
+            reference.lumens.emplace_back(1, static_cast<int>(reference.lumens.size()), 1);
+        }
+        check(matches(nova, reference), where + ": a pooled Nova matches the reference");
+    }
+
+    vector<Lumen*> lumens;
+    for (int i = 0; i < 200; i++) {
+        lumens.push_back(pooled.illuminate(randomInt(1, 50), randomInt(1, 5), randomInt(1, 60)));
+    }
+    for (Lumen* lumen : lumens) {
+        pooled.extinguish(lumen);
+    }
+    int slabs = pooled.getNumSlabs();
+    for (int round = 0; round < 10; round++) {
+        for (Lumen*& lumen : lumens) {
+            int brightness = randomInt(1, 50);
+            int size = randomInt(1, 5);
+            int power = randomInt(1, 60);
+            lumen = pooled.illuminate(brightness, size, power);
+            check(stateOf(*lumen) == stateOf(Lumen(brightness, size, power)), "a reused slot holds a new Lumen");
+        }
+        for (Lumen* lumen : lumens) {
+            pooled.extinguish(lumen);
+        }
+    }
+    check(pooled.getNumSlabs() == slabs, "extinguished slots are illuminated again before new slabs");
+
+    for (Lumen*& lumen : lumens) {
+        lumen = pooled.illuminate(1, 2, 3);
+    }
+    thread other([&pooled, &lumens]() {
+        for (Lumen* lumen : lumens) {
+            pooled.extinguish(lumen);
+        }
+    });
+    other.join();
+    for (Lumen*& lumen : lumens) {
+        lumen = pooled.illuminate(1, 2, 3);
+    }
+    check(pooled.getNumSlabs() == slabs, "slots extinguished on another thread are reused");
+    for (Lumen* lumen : lumens) {
+        pooled.extinguish(lumen);
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: the Nova comparison operators are checked (equal lumens, ordered by lumen count)
+void checkComparisons() {
+    Nova nova1(&luminate, 5, 10, 20, 3);
+    Nova nova2(&luminate, 5, 10, 20, 3);
+    check(nova1 == nova2 && !(nova1 != nova2), "Novas with the same lumens are equal");
+    nova2.lumen(0).reset(); // fails before any glow and dims the lumen by one
+    check(nova1 != nova2 && !(nova1 == nova2), "Novas with different lumens are not equal");
+
+    Nova nova3(&luminate, 1, 2, 3, 2);
+    Nova nova4(&luminate, 2, 3, 4, 3);
+    check(nova3 < nova4 && nova3 <= nova4 && !(nova3 > nova4) && !(nova3 >= nova4),
+          "Novas are ordered by their number of lumens");
+    Nova nova5(&luminate, 9, 9, 9, 2);
+    check(!(nova3 < nova5) && nova3 <= nova5 && nova3 >= nova5, "Novas with as many lumens are ordered equal");
+}
+
+// Pre-Condition: reference holds at least one lumen
+// Post-Condition: Returns the current glow values of reference, sorted
+vector<int> sortedGlowValues(ReferenceNova& reference) {
+    vector<int> values;
+    for (Lumen& lumen : reference.lumens) {
+        values.push_back(lumen.currentGlowValue());
+    }
+    sort(values.begin(), values.end());
+    return values;
+}
+
+// Pre-Condition: values is sorted and not empty; 0 <= q <= 1
+// Post-Condition: Returns the value of nearest rank ceil(q * size) of values
+int nearestRank(const vector<int>& values, double q) {
+    long long rank = static_cast<long long>(ceil(q * values.size()));
+    return values[max(1LL, rank) - 1];
+}
+
+// Pre-Condition: values is sorted and not empty
+// Post-Condition: Returns true if count, sum, min, max and the p50/p95/p99 estimates of stats
+//                 describe values, the estimates within 1/128 of the exact percentile
+bool describes(const GlowStats& stats, const vector<int>& values) {
+    long long sum = 0;
+    for (int value : values) {
+        sum += value;
+    }
+    bool same = stats.count() == static_cast<long long>(values.size()) && stats.sum() == sum
+                && stats.min() == values.front() && stats.max() == values.back();
+    for (double q : {0.5, 0.95, 0.99}) {
+        long long exact = nearestRank(values, q);
+        same = same && llabs(stats.percentile(q) - exact) <= llabs(exact) / 128;
+    }
+    return same;
+}
+
+// Pre-Condition: None
+// Post-Condition: Returns true if topK(k) and bottomK(k) of nova list the lumens of reference
+//                 sorted by glow value, brightest / dimmest first, ties by index
+bool ranksLike(const Nova& nova, ReferenceNova& reference, int k) {
+    vector<LumenGlow> sorted;
+    for (int i = 0; i < static_cast<int>(reference.lumens.size()); i++) {
+        sorted.push_back(LumenGlow{i, reference.lumens[i].currentGlowValue()});
     }
+    auto byIndex = [](const LumenGlow& a, const LumenGlow& b) { return a.index < b.index; };
+    auto same = [](const LumenGlow& a, const LumenGlow& b) {
+        return a.index == b.index && a.glowValue == b.glowValue;
+    };
+    int listed = min(k, static_cast<int>(sorted.size()));
 
-    // Modify nova2
-    nova2.glow(2);
+    stable_sort(sorted.begin(), sorted.end(), [](const LumenGlow& a, const LumenGlow& b) {
+        return a.glowValue > b.glowValue;
+    });
+    vector<LumenGlow> top = nova.topK(k);
+    bool ok = static_cast<int>(top.size()) == listed && equal(top.begin(), top.end(), sorted.begin(), same);
 
-    // Test inequality
-    if (nova1 != nova2) {
-        std::cout << "Nova1 and Nova2 are not equal" << std::endl;
-    } else {
-        std::cout << "Nova1 and Nova2 are equal" << std::endl;
+    sort(sorted.begin(), sorted.end(), byIndex);
+    stable_sort(sorted.begin(), sorted.end(), [](const LumenGlow& a, const LumenGlow& b) {
+        return a.glowValue < b.glowValue;
+    });
+    vector<LumenGlow> bottom = nova.bottomK(k);
+    return ok && static_cast<int>(bottom.size()) == listed
+           && equal(bottom.begin(), bottom.end(), sorted.begin(), same);
+}
+
+// Pre-Condition: None
+// Post-Condition: topK and bottomK are checked against a sorted reference while lumens glow, change,
+//                 are added and are dropped
+void checkTopK() {
+    for (int scenario = 0; scenario < 200; scenario++) {
+        string where = "top-k scenario " + to_string(scenario);
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS);
+        Nova nova(&luminate, brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        bool same = true;
+        for (int round = 0; round < 8 && same; round++) {
+            scramble(nova, reference, randomInt(0, 20));
+            int change = randomInt(0, 2);
+            int count = randomInt(0, n / 2);
+            if (change == 1) {
+                // the lumens append() adds, as ++ makes them
+                for (int i = 0; i < count; i++) {
+                    reference.lumens.emplace_back(1, static_cast<int>(reference.lumens.size()), 1);
+                }
+                nova.append(count);
+            } else if (change == 2 && count < nova.getNumLumens()) {
+                nova.truncate(count);
+                reference.lumens.erase(reference.lumens.end() - count, reference.lumens.end());
+            }
+            n = nova.getNumLumens();
+            same = matches(nova, reference) && ranksLike(nova, reference, randomInt(0, n + 2))
+                   && ranksLike(nova, reference, n);
+        }
+        check(same, where + ": topK and bottomK list the sorted glow values");
     }
+}
+
+// Pre-Condition: None
+// Post-Condition: glowStats, merged GlowStats, glowPercentile and NovaEngine::glowStats are checked
+//                 against the sorted glow values of the reference
+void checkGlowStats() {
+    vector<unique_ptr<Nova>> fleet;
+    vector<int> fleetValues;
+    for (int scenario = 0; scenario < 100; scenario++) {
+        string where = "glow stats scenario " + to_string(scenario);
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS);
+        unique_ptr<Nova> nova = make_unique<Nova>(&luminate, brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        scramble(*nova, reference, randomInt(0, 60));
+        vector<int> values = sortedGlowValues(reference);
+
+        check(describes(nova->glowStats(), values), where + ": glowStats describes the glow values");
+        bool exact = true;
+        for (double q : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 1.0}) {
+            exact = exact && nova->glowPercentile(q) == nearestRank(values, q);
+        }
+        check(exact, where + ": glowPercentile is the exact nearest-rank value");
 
-    // Create two new Nova objects for comparing
-    Nova nova3(1, 2, 3, 2);
-    Nova nova4(2, 3, 4, 2);
+        GlowStats merged;
+        nova->addGlowStats(merged);
+        if (!fleet.empty()) {
+            merged.merge(fleet.back()->glowStats());
+        }
+        vector<int> mergedValues = values;
+        if (!fleet.empty()) {
+            for (int i = 0; i < fleet.back()->getNumLumens(); i++) {
+                mergedValues.push_back(fleet.back()->currentGlowValue(i));
+            }
+            sort(mergedValues.begin(), mergedValues.end());
+        }
+        check(describes(merged, mergedValues), where + ": merged GlowStats describe both Novas");
 
-    // Test '<' operator
-    if (nova3 < nova4) {
-        std::cout << "Nova3 is less than Nova4" << std::endl;
-    } else {
-        std::cout << "Nova3 is not less than Nova4" << std::endl;
+        fleetValues.insert(fleetValues.end(), values.begin(), values.end());
+        fleet.push_back(move(nova));
     }
+    fleet.push_back(nullptr);
 
-    // Test '>' operator
-    if (nova3 > nova4) {
-        std::cout << "Nova3 is greater than Nova4" << std::endl;
-    } else {
-        std::cout << "Nova3 is not greater than Nova4" << std::endl;
+    sort(fleetValues.begin(), fleetValues.end());
+    NovaEngine engine(fleet, 3);
+    check(describes(engine.glowStats(), fleetValues), "NovaEngine::glowStats describes the whole fleet");
+}
+
+} // namespace
+
+// Pre-Condition: None
+// Post-Condition: append(Nova&&) is checked against the concatenated reference, into an empty and
+//                 a non-empty Nova; the moved-from Nova is empty and its copies keep their lumens
+void checkMovedAppend() {
+    for (int scenario = 0; scenario < 100; scenario++) {
+        string where = "moved append scenario " + to_string(scenario);
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS / 2);
+        int m = randomInt(1, MAXLUMENS / 2);
+        Nova receiver(&luminate, brightness, size, power, n);
+        ReferenceNova reference(brightness, size, power, n);
+        Nova other(&luminate, brightness + 1, size, power, m);
+        ReferenceNova otherReference(brightness + 1, size, power, m);
+        scramble(receiver, reference, randomInt(0, 20));
+        scramble(other, otherReference, randomInt(0, 20));
+        Nova otherCopy = other;
+        string otherState = stateOf(other);
+        if (scenario % 2 == 0) {
+            // an empty receiver takes other's bank as is
+            receiver.releaseLumens();
+            reference.lumens.clear();
+        }
+        receiver.append(std::move(other));
+        reference.lumens.insert(reference.lumens.end(), otherReference.lumens.begin(),
+                                otherReference.lumens.end());
+        check(other.getNumLumens() == 0, where + ": the moved-from Nova holds no lumens");
+        check(matches(receiver, reference), where + ": the receiver holds its lumens, then other's");
+        int x = randomInt(0, receiver.getNumLumens());
+        receiver.glow(x);
+        reference.glow(x);
+        check(matches(receiver, reference), where + ": the receiver glows like the reference");
+        check(stateOf(otherCopy) == otherState, where + ": a copy of other keeps its lumens");
     }
+}
+
+// Pre-Condition: None
+// Post-Condition: Nova + Nova and Nova - Nova chains are checked against Lumen values summed by
+//                 hand, and their comparisons and queries against the Nova they convert to
+void checkExpressions() {
+    for (int scenario = 0; scenario < 100; scenario++) {
+        string where = "expression scenario " + to_string(scenario);
+        int n = randomInt(1, 100); // sums of three operands keep glow values within int
+        Nova a(&luminate, randomInt(1, 50), randomInt(1, 5), randomInt(1, 60), n);
+        Nova b(&luminate, randomInt(1, 50), randomInt(1, 5), randomInt(1, 60), n);
+        Nova c(&luminate, randomInt(1, 50), randomInt(1, 5), randomInt(1, 60), n);
+
+        // a + b - c as the eager operators built it: sums, then differences raised to 1
+        ReferenceNova expected(1, 1, 1, 0);
+        for (int i = 0; i < n; i++) {
+            Lumen la = a.lumen(i).toLumen();
+            Lumen lb = b.lumen(i).toLumen();
+            Lumen lc = c.lumen(i).toLumen();
+            expected.lumens.emplace_back(max(1, la.getBrightness() + lb.getBrightness() - lc.getBrightness()),
+                                         max(1, la.getSize() + lb.getSize() - lc.getSize()),
+                                         max(1, la.getPower() + lb.getPower() - lc.getPower()));
+        }
+        Nova chain = a + b - c;
+        check(matches(chain, expected), where + ": a + b - c holds the summed lumens");
+
+        check((a + b - c) == chain && chain == (a + b - c) && !((a + b - c) != chain),
+              where + ": an expression equals the Nova it converts to");
+        check((a - c) != (a + c) && !((a - c) == (a + c)), where + ": different expressions are not equal");
+        Nova larger(&luminate, 1, 1, 1, n + 1);
+        check((a + b) < larger && larger > (a - b) && (a + b) <= a && (a + b) >= a
+              && !((a + b) < (a - b)) && !((a + b) > a),
+              where + ": expressions are ordered by their number of lumens");
+
+        int i = randomInt(0, n - 1);
+        check((a + b - c).minGlow() == chain.minGlow() && (a + b - c).maxGlow() == chain.maxGlow()
+              && (a + b - c).getNumLumens() == n
+              && (a + b - c).getNumActiveLumens() == chain.getNumActiveLumens()
+              && (a + b - c).getNumErraticLumens() == chain.getNumErraticLumens()
+              && (a + b - c).getNumInactiveLumens() == chain.getNumInactiveLumens()
+              && (a + b - c).currentGlowValue(i) == chain.currentGlowValue(i),
+              where + ": expression queries answer like the Nova it converts to");
 
-    // Test '<=' operator
-    if (nova3 <= nova4) {
-        std::cout << "Nova3 is less than or equal to Nova4" << std::endl;
-    } else {
-        std::cout << "Nova3 is not less than or equal to Nova4" << std::endl;
+        a.glow(randomInt(0, n));
+        c.glow(randomInt(0, n));
+        Nova sum = a + b;
+        check((a + b - c) == (sum - c) && (a + b - c).minGlow() == Nova(sum - c).minGlow(),
+              where + ": a fused chain equals one built a step at a time");
     }
+}
 
-    // Test '>=' operator
-    if (nova3 >= nova4) {
-        std::cout << "Nova3 is greater than or equal to Nova4" << std::endl;
-    } else {
-        std::cout << "Nova3 is not greater than or equal to Nova4" << std::endl;
+// Pre-Condition: None
+// Post-Condition: Returns the state NovaMetrics counts lumen as being in
+LumenState stateIn(Lumen& lumen) {
+    if (lumen.isActive()) {
+        return LumenState::Active;
     }
+    return lumen.isErratic() ? LumenState::Erratic : LumenState::Dimmed;
+}
+
+// Pre-Condition: None
+// Post-Condition: every lumen that changed state between before and reference is counted in
+//                 counts, under the counter NovaMetrics uses for that transition
+void countTransitions(const vector<LumenState>& before, ReferenceNova& reference, uint64_t* counts) {
+    for (size_t i = 0; i < before.size(); i++) {
+        LumenState from = before[i];
+        LumenState to = stateIn(reference.lumens[i]);
+        if (from == to) {
+            continue;
+        }
+        NovaCounter counter = NovaCounter::ErraticToDimmed;
+        if (to == LumenState::Active) {
+            counter = NovaCounter::Reactivated;
+        } else if (from == LumenState::Active) {
+            counter = to == LumenState::Erratic ? NovaCounter::ActiveToErratic : NovaCounter::ActiveToDimmed;
+        }
+        counts[static_cast<int>(counter)]++;
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: every NovaMetrics counter is checked against the same glows, resets and recharges
+//                 run on the reference: state transitions and recharge rounds as the reference saw
+//                 them, reset outcomes as the original Lumen::reset counted them
+void checkMetrics() {
+    if (!NovaMetrics::enabled()) {
+        return;
+    }
+    for (int scenario = 0; scenario < 100; scenario++) {
+        string where = "metrics scenario " + to_string(scenario);
+        int brightness = randomInt(1, 50);
+        int size = randomInt(1, 5);
+        int power = randomInt(1, 60);
+        int n = randomInt(1, MAXLUMENS / 4);
+        // half the scenarios keep resetting the first lumens until they run out of resets
+        int lastTarget = scenario % 2 ? n - 1 : min(n - 1, 3);
+        vector<pair<int, int>> steps; // (operation, lumen index or glow count)
+        for (int step = randomInt(0, 200); step > 0; step--) {
+            int op = randomInt(0, 5);
+            steps.emplace_back(op, op < 2 ? randomInt(0, lastTarget) : randomInt(0, n));
+        }
+
+        uint64_t expected[NUMNOVACOUNTERS] = {};
+        NovaMetrics::reset();
+        ReferenceNova reference(brightness, size, power, n);
+        for (const pair<int, int>& step : steps) {
+            vector<LumenState> before;
+            for (Lumen& lumen : reference.lumens) {
+                before.push_back(stateIn(lumen));
+            }
+            if (step.first == 0) {
+                reference.lumens[step.second].reset();
+            } else if (step.first == 1) {
+                reference.lumens[step.second].recharge();
+            } else {
+                reference.glow(step.second);
+                expected[static_cast<int>(NovaCounter::NovaGlows)]++;
+                expected[static_cast<int>(NovaCounter::LumenGlows)] += step.second;
+            }
+            countTransitions(before, reference, expected);
+        }
+        for (NovaCounter counter : {NovaCounter::ResetSuccesses, NovaCounter::ResetFailures,
+                                    NovaCounter::ResetsExhausted}) {
+            expected[static_cast<int>(counter)] = NovaMetrics::value(counter);
+        }
+        expected[static_cast<int>(NovaCounter::RechargeRounds)] = reference.rechargeRounds;
+        // every lumen is illuminated once and handed back once its values are in the bank
+        expected[static_cast<int>(NovaCounter::LumenAllocations)] = n;
+        expected[static_cast<int>(NovaCounter::LumenFrees)] = n;
+
+        NovaMetrics::reset();
+        Nova nova(&luminate, brightness, size, power, n);
+        for (const pair<int, int>& step : steps) {
+            if (step.first == 0) {
+                nova.lumen(step.second).reset();
+            } else if (step.first == 1) {
+                nova.lumen(step.second).recharge();
+            } else {
+                nova.glow(step.second);
+            }
+        }
+        for (int c = 0; c < NUMNOVACOUNTERS; c++) {
+            NovaCounter counter = static_cast<NovaCounter>(c);
+            check(NovaMetrics::value(counter) == expected[c],
+                  where + ": " + NovaMetrics::name(counter) + " is " + to_string(NovaMetrics::value(counter))
+                  + ", the reference counted " + to_string(expected[c]));
+        }
+        check(matches(nova, reference), where + ": the Nova matches the reference");
+    }
+    NovaMetrics::reset();
+}
+
+int main() {
+    checkKernelSets();
+    checkSnapshots();
+#ifdef NOVA_FLEET_IMAGE
+    checkFleetImage();
+#endif
+    checkPackedLumen();
+    checkFixedNova();
+    checkLazyNova();
+    checkPooledLuminosity();
+    checkComparisons();
+    checkGlowStats();
+    checkTopK();
+    checkMovedAppend();
+    checkExpressions();
+    checkMetrics();
+
+    if (failures == 0) {
+        std::cout << "All checks passed" << std::endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
 
-    return 0;
-}
\ No newline at end of file
+/*
+Implementation Invariant:
+- Every optimized Nova is compared against a ReferenceNova that went through the same operations
+  in the same order, and the reference only uses the public Lumen operations.
+- Kernel sets run the same random scenarios (the generator is reseeded for each), so their Nova
+  states can be compared byte for byte.
+*/
@@ -0,0 +1,104 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The TimingWheel class places an event by the highest group of SLOTBITS bits in which its tick
+differs from the current tick. When the current tick reaches the start of a slot of a higher
+level, the events of that slot are placed again and fall into lower levels; an event reaches
+level 0 before its tick comes and is handed out on exactly that tick.
+
+ASSUMPTIONS:
+- Ticks are non-negative.
+*/
+
+#include "timing_wheel.h"
+#include <stdexcept>
+#include <utility>
+
+// Pre-Condition: start is non-negative
+// Post-Condition: an empty wheel whose current tick is start is created
+TimingWheel::TimingWheel(long long start) : slots(LEVELS * SLOTS), current(start) {}
+
+// Pre-Condition: None
+// Post-Condition: Returns the current tick
+long long TimingWheel::now() const {
+    return current;
+}
+
+// Pre-Condition: when > now()
+// Post-Condition: id is handed out by the advance() that reaches tick when
+void TimingWheel::schedule(int id, long long when) {
+    if (when <= current) {
+        throw std::out_of_range("Events must be scheduled after the current tick.");
+    }
+    place(Event{id, when});
+}
+
+// Pre-Condition: None
+// Post-Condition: the wheel is one tick further; due holds the ids of every event due at the new tick
+void TimingWheel::advance(std::vector<int>& due) {
+    due.clear();
+    current++;
+
+    // the highest level whose slot starts at this tick
+    int top = 0;
+    while (top < LEVELS && (current & ((1LL << (SLOTBITS * (top + 1))) - 1)) == 0) {
+        top++;
+    }
+    if (top == LEVELS) {
+        replace(overflow);
+        top = LEVELS - 1;
+    }
+    for (int level = top; level >= 1; level--) {
+        int slot = static_cast<int>((current >> (SLOTBITS * level)) & (SLOTS - 1));
+        replace(slots[level * SLOTS + slot]);
+    }
+
+    std::vector<Event>& ready = slots[current & (SLOTS - 1)];
+    for (const Event& event : ready) {
+        due.push_back(event.id);
+    }
+    ready.clear();
+}
+
+// Pre-Condition: event.when >= current
+// Post-Condition: event is in the slot its tick belongs to, or in overflow
+void TimingWheel::place(const Event& event) {
+    long long differing = event.when ^ current;
+    int level = 0;
+    while (level < LEVELS && (differing >> (SLOTBITS * (level + 1))) != 0) {
+        level++;
+    }
+    if (level == LEVELS) {
+        overflow.push_back(event);
+        return;
+    }
+    int slot = static_cast<int>((event.when >> (SLOTBITS * level)) & (SLOTS - 1));
+    slots[level * SLOTS + slot].push_back(event);
+}
+
+// Pre-Condition: every event in events is due at or after current
+// Post-Condition: the events are placed again relative to the current tick; events is empty
+void TimingWheel::replace(std::vector<Event>& events) {
+    std::vector<Event> moving;
+    moving.swap(events);
+    for (const Event& event : moving) {
+        place(event);
+    }
+    // keep the slot's storage for the next time it fills up
+    moving.clear();
+    if (events.empty()) {
+        events.swap(moving);
+    }
+}
+
+
+/*
+Implementation Invariant:
+- advance() places the slots of higher levels again from the top level down, so an event that
+  falls from level L into the slot of level L - 1 that starts at the same tick is moved on
+  again in the same call and reaches level 0 in time.
+*/
@@ -0,0 +1,56 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+TimingWheel.h is the header file for the TimingWheel class, a hierarchical timing wheel that
+keeps events (an int id and the tick it is due at) until their tick comes. Level 0 has one slot
+per tick for the next 256 ticks, every higher level has 256 slots that each cover 256 times the
+span of a slot one level below. Scheduling an event and advancing by one tick cost O(1)
+amortized, however far away the events are.
+*/
+
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <vector>
+
+class TimingWheel {
+public:
+    explicit TimingWheel(long long start = 0);
+
+    long long now() const;
+    void schedule(int id, long long when); // when > now()
+    void advance(std::vector<int>& due); // moves to now() + 1; due receives the ids due at the new now()
+
+private:
+    static constexpr int LEVELS = 5;
+    static constexpr int SLOTBITS = 8;
+    static constexpr int SLOTS = 1 << SLOTBITS;
+
+    struct Event {
+        int id;
+        long long when;
+    };
+
+    std::vector<std::vector<Event>> slots; // LEVELS * SLOTS slots, level by level
+    std::vector<Event> overflow; // events more than LEVELS * SLOTBITS bits of ticks away
+    long long current;
+
+    void place(const Event& event);
+    void replace(std::vector<Event>& events);
+};
+
+#endif // TIMING_WHEEL_H
+
+
+/*
+Class invariants for TimingWheel:
+
+- Every pending event is due after current.
+- An event in level L, slot s agrees with current on every bit above its level-L group of bits
+  and has s as that group; level-0 events are due exactly at the tick whose low bits are s.
+- Events that differ from current above the top level wait in overflow.
+*/
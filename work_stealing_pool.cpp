@@ -0,0 +1,193 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+The WorkStealingPool class runs parallel loops on a fixed set of threads. Each loop is split into
+one contiguous block per participant; owners take tasks from the front of their block, thieves
+take from the back of someone else's, so big and small tasks even out across threads.
+
+ASSUMPTIONS:
+- Tasks of one parallelFor call are independent of each other.
+- The body passed to parallelFor stays alive until parallelFor returns (it does, since
+  parallelFor waits for every worker).
+*/
+
+#include "work_stealing_pool.h"
+#include <climits>
+
+namespace {
+// the pool whose task the current thread is running, if any
+thread_local const WorkStealingPool* currentPool = nullptr;
+}
+
+// Pre-Condition: numThreads is non-negative
+// Post-Condition: numThreads - 1 worker threads are started (the caller is the last participant)
+WorkStealingPool::WorkStealingPool(int numThreads)
+: body(nullptr), generation(0), busyWorkers(0), stopping(false), firstErrorIndex(INT_MAX) {
+    if (numThreads <= 0) {
+        numThreads = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    if (numThreads <= 0) {
+        numThreads = 1;
+    }
+    for (int i = 0; i < numThreads; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (int i = 0; i < numThreads - 1; i++) {
+        workers.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+// Pre-Condition: no parallelFor is running
+// Post-Condition: every worker thread has been stopped and joined
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns the number of threads that run tasks, including the caller
+int WorkStealingPool::getNumThreads() const {
+    return static_cast<int>(queues.size());
+}
+
+// Pre-Condition: count is non-negative; body may be called concurrently for different indices
+// Post-Condition: body(i) has run for every i in [0, count)
+void WorkStealingPool::parallelFor(int count, const std::function<void(int)>& body) {
+    if (count <= 0) {
+        return;
+    }
+    if (workers.empty() || currentPool == this || count == 1) {
+        for (int i = 0; i < count; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> serial(callLock);
+
+    // Hand every participant a contiguous block of indices
+    int participants = getNumThreads();
+    int blockSize = (count + participants - 1) / participants;
+    for (int p = 0; p < participants; p++) {
+        int begin = p * blockSize;
+        int end = begin + blockSize < count ? begin + blockSize : count;
+        std::lock_guard<std::mutex> guard(queues[p]->lock);
+        queues[p]->tasks.clear();
+        for (int i = begin; i < end; i++) {
+            queues[p]->tasks.push_back(i);
+        }
+    }
+
+    firstError = nullptr;
+    firstErrorIndex = INT_MAX;
+    {
+        std::lock_guard<std::mutex> guard(jobLock);
+        this->body = &body;
+        busyWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    jobReady.notify_all();
+
+    const WorkStealingPool* outerPool = currentPool;
+    currentPool = this;
+    runTasks(participants - 1);
+    currentPool = outerPool;
+
+    {
+        std::unique_lock<std::mutex> guard(jobLock);
+        jobDone.wait(guard, [this] { return busyWorkers == 0; });
+        this->body = nullptr;
+    }
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+// Pre-Condition: self is the index of this worker's queue
+// Post-Condition: runs the tasks of each generation until the pool is stopped
+void WorkStealingPool::workerLoop(int self) {
+    currentPool = this;
+    long seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(jobLock);
+            jobReady.wait(guard, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        runTasks(self);
+
+        {
+            std::lock_guard<std::mutex> guard(jobLock);
+            if (--busyWorkers == 0) {
+                jobDone.notify_all();
+            }
+        }
+    }
+}
+
+// Pre-Condition: a parallelFor is running
+// Post-Condition: no task is left in any queue that this participant could take
+void WorkStealingPool::runTasks(int self) {
+    int task;
+    while (takeTask(self, task)) {
+        try {
+            (*body)(task);
+        } catch (...) {
+            std::lock_guard<std::mutex> guard(errorLock);
+            if (task < firstErrorIndex) {
+                firstErrorIndex = task;
+                firstError = std::current_exception();
+            }
+        }
+    }
+}
+
+// Pre-Condition: None
+// Post-Condition: returns true and sets task if a task was taken from our queue or stolen from another one
+bool WorkStealingPool::takeTask(int self, int& task) {
+    {
+        TaskQueue& own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+    int participants = getNumThreads();
+    for (int offset = 1; offset < participants; offset++) {
+        TaskQueue& victim = *queues[(self + offset) % participants];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/*
+Implementation Invariant:
+- parallelFor only returns after busyWorkers reached 0, so no worker touches body afterwards.
+- Tasks are only ever removed from a queue while holding that queue's lock, so each index runs
+  exactly once.
+- Errors are kept for the lowest failing index, which makes the rethrown exception independent
+  of thread count and scheduling.
+*/
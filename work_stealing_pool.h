@@ -0,0 +1,79 @@
+/*
+Name: Sergio Satyabrata
+Date: May 19, 2023
+Class: CPSC-3200
+Revision History: Revised
+Platform: MacBook Pro (OSX)
+
+WorkStealingPool.h is the header file for the WorkStealingPool class, a fixed set of worker
+threads that run parallel loops. parallelFor hands every participant (the workers plus the
+calling thread) a contiguous block of task indices in its own queue; a participant that runs out
+of work steals single tasks from the back of the other queues, so uneven task sizes do not leave
+threads idle.
+*/
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int numThreads = 0); // 0 uses every hardware thread
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int getNumThreads() const; // participants, including the calling thread
+
+    // Runs body(i) for every i in [0, count) and returns once all of them finished.
+    // If any call throws, the exception of the lowest failing index is rethrown.
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+private:
+    struct TaskQueue {
+        std::mutex lock;
+        std::deque<int> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<TaskQueue>> queues; // one per worker, the last one for the caller
+
+    std::mutex callLock; // one parallelFor at a time
+    std::mutex jobLock;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const std::function<void(int)>* body;
+    long generation;
+    int busyWorkers;
+    bool stopping;
+
+    std::mutex errorLock;
+    std::exception_ptr firstError;
+    int firstErrorIndex;
+
+    void workerLoop(int self);
+    void runTasks(int self);
+    bool takeTask(int self, int& task);
+};
+
+#endif // WORK_STEALING_POOL_H
+
+
+/*
+Class invariants for WorkStealingPool:
+
+- queues holds workers.size() + 1 queues; queue i belongs to worker i and the last one to the
+  thread calling parallelFor.
+- body is non-null only while a parallelFor call is running.
+- busyWorkers counts the workers that have not yet finished the current generation.
+- A parallelFor issued from inside one of the pool's own tasks runs sequentially on that thread.
+*/